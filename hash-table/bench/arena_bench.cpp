@@ -0,0 +1,64 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <print>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../cpp/src/hash_table.hpp"
+
+// Bulk-loads `count` keys, deletes and re-inserts every other one, then
+// destroys the table, timing each phase with and without the arena. Keys and
+// values are long enough that neither fits in the small-string buffer.
+// Usage: arena_bench [count]
+static void Run(const std::string_view name, const bool useArena, const std::vector<std::string> &keys)
+{
+    using Clock = std::chrono::steady_clock;
+    const auto ms = [](const Clock::time_point start, const Clock::time_point end) {
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    };
+
+    auto table = std::make_unique<HashTable>(53, HashTableOptions{.useArena = useArena});
+
+    const auto loadStart = Clock::now();
+    for (const std::string &key : keys)
+    {
+        table->Insert(key, key);
+    }
+
+    const auto churnStart = Clock::now();
+    for (size_t i = 0; i < keys.size(); i += 2)
+    {
+        table->Delete(keys[i]);
+    }
+    for (size_t i = 0; i < keys.size(); i += 2)
+    {
+        table->Insert(keys[i], keys[i]);
+    }
+
+    const auto teardownStart = Clock::now();
+    table.reset();
+    const auto end = Clock::now();
+
+    std::println("{:<6} load: {:>8.1f} ms  churn: {:>8.1f} ms  teardown: {:>7.1f} ms",
+                 name, ms(loadStart, churnStart), ms(churnStart, teardownStart), ms(teardownStart, end));
+}
+
+int32_t main(int32_t argc, char **argv)
+{
+    const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+
+    std::vector<std::string> keys;
+    keys.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        keys.push_back("user:session:" + std::to_string(i) + ":payload");
+    }
+
+    Run("heap", false, keys);
+    Run("arena", true, keys);
+
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <print>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../cpp/src/hash_table.hpp"
+
+// Compares single-key Search/Insert/Delete with their batched forms on tables
+// well beyond L3, looking keys up in requests of `batch` keys the way a
+// request handler would.
+// Usage: batch_bench [count] [batch] [rounds]
+template <typename Fn>
+static double Measure(const size_t operations, const size_t rounds, Fn &&fn)
+{
+    double best{};
+    for (size_t round = 0; round < rounds; ++round)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const auto end = std::chrono::steady_clock::now();
+
+        const double seconds = std::chrono::duration<double>(end - start).count();
+        best = std::max(best, static_cast<double>(operations) / seconds);
+    }
+
+    return best / 1e6;
+}
+
+template <typename Table>
+static void Run(const std::string_view name, const std::vector<typename Table::KeyView> &keys, const std::vector<typename Table::KeyView> &misses, const size_t batch, const size_t rounds)
+{
+    using KeyView = typename Table::KeyView;
+    using Value = typename Table::Value;
+
+    Table table;
+    std::vector<Value> values(keys.begin(), keys.end());
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        table.Insert(keys[i], values[i]);
+    }
+
+    std::vector<Value *> results(batch);
+    size_t found{};
+    const auto single = [&](const std::vector<KeyView> &probe) {
+        for (const KeyView key : probe)
+        {
+            found += table.Search(key) != nullptr;
+        }
+    };
+    const auto batched = [&](const std::vector<KeyView> &probe) {
+        for (size_t start = 0; start < probe.size(); start += batch)
+        {
+            const size_t count = std::min(batch, probe.size() - start);
+            table.SearchBatch(std::span(probe).subspan(start, count), std::span(results).first(count));
+            for (size_t i = 0; i < count; ++i)
+            {
+                found += results[i] != nullptr;
+            }
+        }
+    };
+
+    const double hit = Measure(keys.size(), rounds, [&] { single(keys); });
+    const double hitBatch = Measure(keys.size(), rounds, [&] { batched(keys); });
+    const double miss = Measure(misses.size(), rounds, [&] { single(misses); });
+    const double missBatch = Measure(misses.size(), rounds, [&] { batched(misses); });
+
+    // Inserts overwrite the stored values, so both runs see the same table.
+    const double insert = Measure(keys.size(), rounds, [&] {
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            table.Insert(keys[i], values[i]);
+        }
+    });
+    const double insertBatch = Measure(keys.size(), rounds, [&] {
+        for (size_t start = 0; start < keys.size(); start += batch)
+        {
+            const size_t count = std::min(batch, keys.size() - start);
+            table.InsertBatch(std::span(keys).subspan(start, count), std::span(values).subspan(start, count));
+        }
+    });
+
+    std::println("{:<10} search hit  single: {:>6.2f}  batch: {:>6.2f} Mops/s", name, hit, hitBatch);
+    std::println("{:<10} search miss single: {:>6.2f}  batch: {:>6.2f} Mops/s", name, miss, missBatch);
+    std::println("{:<10} insert      single: {:>6.2f}  batch: {:>6.2f} Mops/s", name, insert, insertBatch);
+
+    // Deletes empty the table, so each path gets its own half of the keys.
+    const size_t half = keys.size() / 2;
+    const double erase = Measure(half, 1, [&] {
+        for (size_t i = 0; i < half; ++i)
+        {
+            table.Delete(keys[i]);
+        }
+    });
+    const double eraseBatch = Measure(keys.size() - half, 1, [&] {
+        for (size_t start = half; start < keys.size(); start += batch)
+        {
+            const size_t count = std::min(batch, keys.size() - start);
+            table.DeleteBatch(std::span(keys).subspan(start, count));
+        }
+    });
+    std::println("{:<10} delete      single: {:>6.2f}  batch: {:>6.2f} Mops/s  (found {})", name, erase, eraseBatch, found);
+}
+
+int32_t main(int32_t argc, char **argv)
+{
+    const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4'000'000;
+    const size_t batch = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 64;
+    const size_t rounds = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 3;
+
+    std::mt19937_64 rng(42);
+    std::vector<uint64_t> ids(count);
+    std::vector<uint64_t> missIds(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        ids[i] = rng() & ~1ull;
+        missIds[i] = rng() | 1ull;
+    }
+
+    std::vector<std::string> names;
+    std::vector<std::string> missNames;
+    names.reserve(count);
+    missNames.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        names.push_back("key:" + std::to_string(ids[i]));
+        missNames.push_back("key:" + std::to_string(missIds[i]));
+    }
+
+    std::println("keys: {}, batch: {}", count, batch);
+    Run<BasicHashTable<uint64_t, uint64_t>>("uint64", ids, missIds, batch, rounds);
+    Run<HashTable>("string", std::vector<std::string_view>(names.begin(), names.end()),
+                   std::vector<std::string_view>(missNames.begin(), missNames.end()), batch, rounds);
+
+    return 0;
+}
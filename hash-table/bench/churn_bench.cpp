@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <print>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../cpp/src/hash_table.hpp"
+#include "../cpp/src/robin_hood_hash_table.hpp"
+#include "../cpp/src/swiss_hash_table.hpp"
+
+// Holds `count` live keys while `churn` rounds each delete a random live key
+// and insert a fresh one, then measures lookups on the churned table. Before
+// tombstones were counted, HashTable filled up with them under this workload
+// and its probes never terminated.
+// Usage: churn_bench [count] [churn] [rounds]
+template <typename Table>
+static void Run(const std::string_view name, const size_t count, const size_t churn, const size_t rounds)
+{
+    std::mt19937_64 rng(42);
+    std::vector<std::string> live;
+    live.reserve(count);
+
+    Table table;
+    size_t next{};
+    for (; next < count; ++next)
+    {
+        live.push_back("key:" + std::to_string(next));
+        table.Insert(live.back(), live.back());
+    }
+
+    const auto churnStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < churn; ++i, ++next)
+    {
+        std::string &key = live[rng() % live.size()];
+        table.Delete(key);
+        key = "key:" + std::to_string(next);
+        table.Insert(key, key);
+    }
+    const auto churnEnd = std::chrono::steady_clock::now();
+    const double churnRate = static_cast<double>(churn) / std::chrono::duration<double>(churnEnd - churnStart).count() / 1e6;
+
+    std::vector<std::string> misses;
+    misses.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        misses.push_back("miss:" + std::to_string(i));
+    }
+
+    const auto measure = [&](const std::vector<std::string> &keys) {
+        size_t found{};
+        double best{};
+        for (size_t round = 0; round < rounds; ++round)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            for (const std::string &key : keys)
+            {
+                found += table.Search(key) != nullptr;
+            }
+            const auto end = std::chrono::steady_clock::now();
+            best = std::max(best, static_cast<double>(keys.size()) / std::chrono::duration<double>(end - start).count());
+        }
+
+        if (found == SIZE_MAX)
+        {
+            std::println("unreachable");
+        }
+        return best / 1e6;
+    };
+
+    std::println("{:<20} churn: {:>6.2f}  hit: {:>6.2f}  miss: {:>6.2f} Mops/s  size: {}",
+                 name, churnRate, measure(live), measure(misses), table.GetSize());
+}
+
+int32_t main(int32_t argc, char **argv)
+{
+    const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+    const size_t churn = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10'000'000;
+    const size_t rounds = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 3;
+
+    std::println("live keys: {}, churn: {}", count, churn);
+    Run<HashTable>("HashTable", count, churn, rounds);
+    Run<RobinHoodHashTable>("RobinHoodHashTable", count, churn, rounds);
+    Run<SwissHashTable>("SwissHashTable", count, churn, rounds);
+
+    return 0;
+}
@@ -0,0 +1,133 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <optional>
+#include <print>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "../cpp/src/concurrent_hash_table.hpp"
+#include "../cpp/src/hash_table.hpp"
+#include "../cpp/src/lock_free_hash_table.hpp"
+
+// HashTable behind one global mutex, the way callers protect it today.
+class GlobalLockHashTable
+{
+public:
+    void Insert(const std::string_view key, const std::string_view value)
+    {
+        std::lock_guard lock(mutex_);
+        table_.Insert(key, value);
+    }
+
+    std::optional<std::string> Search(const std::string_view key)
+    {
+        std::lock_guard lock(mutex_);
+        const HashTable::Value *value = table_.Search(key);
+        return value == nullptr ? std::nullopt : std::optional<std::string>(*value);
+    }
+
+private:
+    std::mutex mutex_;
+    HashTable table_;
+};
+
+// Runs `threads` workers for a fixed number of operations each over a table
+// preloaded with `keys`, `readPercent` of them lookups and the rest inserts.
+template <typename Table>
+static double Measure(Table &table, const std::vector<std::string> &keys, const size_t threads, const uint32_t readPercent, const size_t opsPerThread)
+{
+    std::atomic<size_t> ready{};
+    std::atomic<bool> go{};
+    std::vector<std::thread> workers;
+
+    for (size_t t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&, t] {
+            std::mt19937_64 rng(t + 1);
+            ++ready;
+            while (!go.load(std::memory_order_acquire))
+            {
+            }
+
+            size_t found{};
+            for (size_t i = 0; i < opsPerThread; ++i)
+            {
+                const std::string &key = keys[rng() % keys.size()];
+                if (rng() % 100 < readPercent)
+                {
+                    found += table.Search(key).has_value();
+                }
+                else
+                {
+                    table.Insert(key, key);
+                }
+            }
+
+            if (found == SIZE_MAX)
+            {
+                std::println("unreachable");
+            }
+        });
+    }
+
+    while (ready.load() != threads)
+    {
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    return static_cast<double>(threads * opsPerThread) / seconds / 1e6;
+}
+
+// Usage: concurrent_bench [keys] [opsPerThread] [maxThreads]
+int32_t main(int32_t argc, char **argv)
+{
+    const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+    const size_t opsPerThread = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1'000'000;
+    const size_t maxThreads = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 32;
+
+    std::vector<std::string> keys;
+    keys.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        keys.push_back("key:" + std::to_string(i));
+    }
+
+    GlobalLockHashTable global;
+    ConcurrentHashTable sharded;
+    LockFreeHashTable lockFree;
+    for (const std::string &key : keys)
+    {
+        global.Insert(key, key);
+        sharded.Insert(key, key);
+        lockFree.Insert(key, key);
+    }
+
+    std::println("keys: {}, ops/thread: {}, shards: {}", count, opsPerThread, sharded.GetShardCount());
+    for (const uint32_t readPercent : {50u, 90u, 95u, 99u})
+    {
+        for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+        {
+            std::println("reads {:>2}%  threads {:>2}  global lock: {:>7.2f}  sharded: {:>7.2f}  lock-free reads: {:>7.2f} Mops/s",
+                         readPercent, threads,
+                         Measure(global, keys, threads, readPercent, opsPerThread),
+                         Measure(sharded, keys, threads, readPercent, opsPerThread),
+                         Measure(lockFree, keys, threads, readPercent, opsPerThread));
+        }
+    }
+
+    return 0;
+}
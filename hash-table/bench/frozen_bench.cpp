@@ -0,0 +1,76 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <print>
+#include <string>
+#include <vector>
+
+#include "../cpp/src/frozen_hash_table.hpp"
+#include "../cpp/src/hash_table.hpp"
+
+static double SecondsSince(const std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Bytes a pmr::string keeps outside its slot; short strings stay inline.
+static size_t HeapBytes(const std::pmr::string &s)
+{
+    return s.capacity() > std::pmr::string().capacity() ? s.capacity() + 1 : 0;
+}
+
+// Freezes a HashTable and compares memory use and lookup throughput of the
+// two for hits and for misses.
+// Usage: frozen_bench [count]
+int32_t main(int32_t argc, char **argv)
+{
+    const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2'000'000;
+
+    std::vector<std::string> keys, misses;
+    keys.reserve(count);
+    misses.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        keys.push_back("session:" + std::to_string(i));
+        misses.push_back("missing:" + std::to_string(i));
+    }
+
+    HashTable table;
+    for (const std::string &key : keys)
+    {
+        table.Insert(key, key);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    const FrozenHashTable frozen(table);
+    const double freeze = SecondsSince(start);
+
+    size_t tableBytes = table.GetStats().capacity * sizeof(BasicHashTableSlot<HashTableEntry, true>);
+    table.ForEach([&](const std::pmr::string &key, const std::pmr::string &value) {
+        tableBytes += HeapBytes(key) + HeapBytes(value);
+    });
+
+    const auto lookups = [](const std::vector<std::string> &probes, auto &&search) {
+        const auto begin = std::chrono::steady_clock::now();
+        size_t found{};
+        for (const std::string &key : probes)
+        {
+            found += search(key);
+        }
+        return std::pair{found, static_cast<double>(probes.size()) / SecondsSince(begin) / 1e6};
+    };
+    const auto inTable = [&](const std::string &key) { return table.Search(key) != nullptr; };
+    const auto inFrozen = [&](const std::string &key) { return frozen.Search(key).has_value(); };
+    const auto [tableHits, tableHitRate] = lookups(keys, inTable);
+    const auto [frozenHits, frozenHitRate] = lookups(keys, inFrozen);
+    const auto [tableMisses, tableMissRate] = lookups(misses, inTable);
+    const auto [frozenMisses, frozenMissRate] = lookups(misses, inFrozen);
+
+    std::println("keys: {}, freeze: {:.3f} s", count, freeze);
+    std::println("memory   HashTable: {:.1f} B/key  frozen: {:.1f} B/key", static_cast<double>(tableBytes) / count,
+                 static_cast<double>(frozen.GetMemoryUsage()) / count);
+    std::println("hits     HashTable: {:.2f}  frozen: {:.2f} Mops/s", tableHitRate, frozenHitRate);
+    std::println("misses   HashTable: {:.2f}  frozen: {:.2f} Mops/s", tableMissRate, frozenMissRate);
+    std::println("found: {} / {}, false hits: {} / {}", tableHits, frozenHits, tableMisses, frozenMisses);
+    return 0;
+}
@@ -0,0 +1,466 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <print>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+extern "C"
+{
+#include "../c/src/hash_table.h"
+}
+
+#include "../cpp/src/hash_table.hpp"
+#include "../cpp/src/robin_hood_hash_table.hpp"
+#include "../cpp/src/swiss_hash_table.hpp"
+
+// Workload matrix over every table implementation, with std::unordered_map
+// as the baseline:
+//   insert      build a table of `size` keys from empty
+//   find-N      lookups where N% of the keys are present, drawn uniformly
+//               or Zipf-distributed (s = 0.99) over the stored keys
+//   churn       erase a random live key and insert a fresh one
+// each with short keys (up to 15 bytes, inside the small-string buffer) and
+// long ones (about 60 bytes sharing a URL-like prefix).
+//
+// The default sizes step from L1-resident (256 short keys) through L2 and
+// L3 to roughly ten times a 32 MiB last-level cache (4M keys); --sizes
+// replaces them. Every result is the median of --repetitions runs.
+//
+// Usage: hash_table_bench [--format=json|csv] [--sizes=256,4096,...] [--ops=N]
+//                         [--repetitions=N] [--tables=HashTable,hash_table_t,...]
+
+class CppTable
+{
+public:
+    static constexpr std::string_view Name = "HashTable";
+
+    void Insert(const std::string &key, const std::string &value) { table_.Insert(key, value); }
+    bool Find(const std::string &key) { return table_.Search(key) != nullptr; }
+    void Erase(const std::string &key) { table_.Delete(key); }
+
+private:
+    HashTable table_;
+};
+
+class CTable
+{
+public:
+    static constexpr std::string_view Name = "hash_table_t";
+
+    CTable() : table_(create_hash_table(53)) {}
+    CTable(const CTable &) = delete;
+    CTable &operator=(const CTable &) = delete;
+    ~CTable() { delete_hash_table(table_); }
+
+    void Insert(const std::string &key, const std::string &value) { hash_table_insert_n(table_, key.data(), key.size(), value.data(), value.size()); }
+    bool Find(const std::string &key) { return hash_table_search_n(table_, key.data(), key.size(), nullptr) != nullptr; }
+    void Erase(const std::string &key) { hash_table_delete_n(table_, key.data(), key.size()); }
+
+private:
+    hash_table_t *table_;
+};
+
+template <typename Table>
+class StringViewTable
+{
+public:
+    void Insert(const std::string &key, const std::string &value) { table_.Insert(key, value); }
+    bool Find(const std::string &key) { return table_.Search(key) != nullptr; }
+    void Erase(const std::string &key) { table_.Delete(key); }
+
+private:
+    Table table_;
+};
+
+class SwissTable : public StringViewTable<SwissHashTable>
+{
+public:
+    static constexpr std::string_view Name = "SwissHashTable";
+};
+
+class RobinHoodTable : public StringViewTable<RobinHoodHashTable>
+{
+public:
+    static constexpr std::string_view Name = "RobinHoodHashTable";
+};
+
+class StdTable
+{
+public:
+    static constexpr std::string_view Name = "std::unordered_map";
+
+    void Insert(const std::string &key, const std::string &value) { table_.insert_or_assign(key, value); }
+    bool Find(const std::string &key) { return table_.find(key) != table_.end(); }
+    void Erase(const std::string &key) { table_.erase(key); }
+
+private:
+    std::unordered_map<std::string, std::string> table_;
+};
+
+enum class KeyLength : uint8_t
+{
+    Short,
+    Long,
+};
+
+enum class Distribution : uint8_t
+{
+    Uniform,
+    Zipf,
+};
+
+struct Options
+{
+    bool csv = false;
+    std::vector<size_t> sizes = {256, 4096, 65536, 1 << 20, 1 << 22};
+    size_t ops = 1'000'000;
+    size_t repetitions = 5;
+    std::vector<std::string> tables;
+};
+
+struct Result
+{
+    std::string_view table;
+    std::string workload;
+    std::string_view distribution;
+    std::string_view keyLength;
+    size_t size;
+    size_t ops;
+    double nsPerOp;
+};
+
+// Everything a run over one size and key length needs, generated up front so
+// no table pays for key construction or random numbers inside the timed loops.
+struct Workload
+{
+    std::vector<std::string> keys;
+    std::vector<std::string> misses;
+    // Fresh keys inserted by churn, and the live-key index each one replaces.
+    std::vector<std::string> fresh;
+    std::vector<size_t> victims;
+};
+
+static size_t sink;
+
+static std::string MakeKey(const size_t n, const KeyLength length, const std::string_view tag)
+{
+    if (length == KeyLength::Short)
+    {
+        return std::string(tag) + std::to_string(n);
+    }
+
+    return "https://example.com/accounts/" + std::string(tag) + "/" + std::to_string(n) + "/profile/settings";
+}
+
+static Workload MakeWorkload(const size_t size, const KeyLength length, const size_t ops, std::mt19937_64 &rng)
+{
+    Workload workload;
+    workload.keys.reserve(size);
+    workload.misses.reserve(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        workload.keys.push_back(MakeKey(i, length, "k"));
+        workload.misses.push_back(MakeKey(i, length, "m"));
+    }
+
+    workload.fresh.reserve(ops);
+    workload.victims.reserve(ops);
+    for (size_t i = 0; i < ops; ++i)
+    {
+        workload.fresh.push_back(MakeKey(size + i, length, "k"));
+        workload.victims.push_back(rng() % size);
+    }
+
+    return workload;
+}
+
+// Key indices for `ops` lookups. Zipf ranks are mapped through a random
+// permutation, so the hot keys are not simply the first ones inserted.
+static std::vector<size_t> MakeIndices(const size_t size, const size_t ops, const Distribution distribution, std::mt19937_64 &rng)
+{
+    std::vector<size_t> indices(ops);
+    if (distribution == Distribution::Uniform)
+    {
+        for (size_t &index : indices)
+        {
+            index = rng() % size;
+        }
+        return indices;
+    }
+
+    std::vector<double> cdf(size);
+    double total{};
+    for (size_t rank = 0; rank < size; ++rank)
+    {
+        total += 1.0 / std::pow(static_cast<double>(rank + 1), 0.99);
+        cdf[rank] = total;
+    }
+
+    std::vector<size_t> permutation(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        permutation[i] = i;
+    }
+    std::shuffle(permutation.begin(), permutation.end(), rng);
+
+    std::uniform_real_distribution<double> uniform(0.0, total);
+    for (size_t &index : indices)
+    {
+        const size_t rank = std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin();
+        index = permutation[std::min(rank, size - 1)];
+    }
+    return indices;
+}
+
+template <typename Fn>
+static double Median(const size_t repetitions, Fn &&run)
+{
+    std::vector<double> samples;
+    for (size_t i = 0; i < repetitions; ++i)
+    {
+        samples.push_back(run());
+    }
+
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+template <typename Fn>
+static double Time(Fn &&fn)
+{
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+template <typename Table>
+static void Fill(Table &table, const std::vector<std::string> &keys)
+{
+    for (const std::string &key : keys)
+    {
+        table.Insert(key, key);
+    }
+}
+
+template <typename Table>
+static void RunTable(const Options &options, const Workload &workload, const std::vector<std::vector<size_t>> &indices,
+                     const std::string_view keyLength, std::vector<Result> &results)
+{
+    const size_t size = workload.keys.size();
+    const auto add = [&](std::string workloadName, const std::string_view distribution, const size_t ops, const double ns) {
+        results.push_back({Table::Name, std::move(workloadName), distribution, keyLength, size, ops, ns / static_cast<double>(ops)});
+    };
+
+    // Small tables are rebuilt until about `ops` keys have gone in, so the
+    // timer never measures just a few microseconds.
+    const size_t builds = std::max<size_t>(1, options.ops / size);
+    add("insert", "uniform", builds * size, Median(options.repetitions, [&] {
+            double ns{};
+            for (size_t i = 0; i < builds; ++i)
+            {
+                Table table;
+                ns += Time([&] { Fill(table, workload.keys); });
+            }
+            return ns;
+        }));
+
+    Table table;
+    Fill(table, workload.keys);
+
+    const std::string_view distributions[] = {"uniform", "zipf"};
+    for (const uint32_t hitPercent : {100u, 50u, 0u})
+    {
+        for (size_t d = 0; d < indices.size(); ++d)
+        {
+            // The same mix of hits and misses for every table; misses are
+            // drawn uniformly from keys that were never inserted.
+            std::mt19937_64 rng(hitPercent);
+            std::vector<const std::string *> queries;
+            queries.reserve(options.ops);
+            for (const size_t index : indices[d])
+            {
+                queries.push_back(rng() % 100 < hitPercent ? &workload.keys[index] : &workload.misses[rng() % size]);
+            }
+
+            add("find-" + std::to_string(hitPercent), distributions[d], queries.size(), Median(options.repetitions, [&] {
+                    return Time([&] {
+                        size_t found{};
+                        for (const std::string *query : queries)
+                        {
+                            found += table.Find(*query);
+                        }
+                        sink += found;
+                    });
+                }));
+        }
+    }
+
+    add("churn", "uniform", workload.fresh.size(), Median(options.repetitions, [&] {
+            Table churned;
+            Fill(churned, workload.keys);
+            std::vector<const std::string *> live;
+            live.reserve(size);
+            for (const std::string &key : workload.keys)
+            {
+                live.push_back(&key);
+            }
+
+            return Time([&] {
+                for (size_t i = 0; i < workload.fresh.size(); ++i)
+                {
+                    const std::string *&victim = live[workload.victims[i]];
+                    churned.Erase(*victim);
+                    victim = &workload.fresh[i];
+                    churned.Insert(*victim, *victim);
+                }
+            });
+        }));
+}
+
+template <typename Table>
+static void RunIfSelected(const Options &options, const Workload &workload, const std::vector<std::vector<size_t>> &indices,
+                          const std::string_view keyLength, std::vector<Result> &results)
+{
+    if (options.tables.empty() || std::find(options.tables.begin(), options.tables.end(), Table::Name) != options.tables.end())
+    {
+        RunTable<Table>(options, workload, indices, keyLength, results);
+    }
+}
+
+static std::vector<std::string> Split(const std::string_view list)
+{
+    std::vector<std::string> items;
+    size_t start = 0;
+    while (start <= list.size())
+    {
+        const size_t end = std::min(list.find(',', start), list.size());
+        if (end > start)
+        {
+            items.emplace_back(list.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+    return items;
+}
+
+static bool ParseOptions(const int32_t argc, char **argv, Options &options)
+{
+    for (int32_t i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        const size_t equals = arg.find('=');
+        const std::string_view name = arg.substr(0, equals);
+        const std::string_view value = equals == std::string_view::npos ? std::string_view() : arg.substr(equals + 1);
+
+        if (name == "--format" && (value == "json" || value == "csv"))
+        {
+            options.csv = value == "csv";
+        }
+        else if (name == "--sizes")
+        {
+            options.sizes.clear();
+            for (const std::string &size : Split(value))
+            {
+                options.sizes.push_back(std::strtoull(size.c_str(), nullptr, 10));
+            }
+        }
+        else if (name == "--ops")
+        {
+            options.ops = std::strtoull(std::string(value).c_str(), nullptr, 10);
+        }
+        else if (name == "--repetitions")
+        {
+            options.repetitions = std::strtoull(std::string(value).c_str(), nullptr, 10);
+        }
+        else if (name == "--tables")
+        {
+            options.tables = Split(value);
+        }
+        else
+        {
+            std::println(stderr, "unknown option: {}", arg);
+            return false;
+        }
+    }
+
+    const bool valid = options.ops > 0 && options.repetitions > 0 && !options.sizes.empty() &&
+                       std::find(options.sizes.begin(), options.sizes.end(), 0) == options.sizes.end();
+    if (!valid)
+    {
+        std::println(stderr, "--ops, --repetitions and every size must be positive");
+    }
+    return valid;
+}
+
+static void PrintJson(const std::vector<Result> &results)
+{
+    std::println("[");
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result &result = results[i];
+        std::println("  {{\"table\": \"{}\", \"workload\": \"{}\", \"distribution\": \"{}\", \"keyLength\": \"{}\", "
+                     "\"size\": {}, \"ops\": {}, \"nsPerOp\": {:.3f}}}{}",
+                     result.table, result.workload, result.distribution, result.keyLength,
+                     result.size, result.ops, result.nsPerOp, i + 1 < results.size() ? "," : "");
+    }
+    std::println("]");
+}
+
+static void PrintCsv(const std::vector<Result> &results)
+{
+    std::println("table,workload,distribution,key_length,size,ops,ns_per_op");
+    for (const Result &result : results)
+    {
+        std::println("{},{},{},{},{},{},{:.3f}", result.table, result.workload, result.distribution, result.keyLength,
+                     result.size, result.ops, result.nsPerOp);
+    }
+}
+
+int32_t main(int32_t argc, char **argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        return 1;
+    }
+
+    std::vector<Result> results;
+    for (const size_t size : options.sizes)
+    {
+        for (const KeyLength length : {KeyLength::Short, KeyLength::Long})
+        {
+            std::mt19937_64 rng(size);
+            const Workload workload = MakeWorkload(size, length, options.ops, rng);
+            const std::vector<std::vector<size_t>> indices = {
+                MakeIndices(size, options.ops, Distribution::Uniform, rng),
+                MakeIndices(size, options.ops, Distribution::Zipf, rng),
+            };
+            const std::string_view keyLength = length == KeyLength::Short ? "short" : "long";
+
+            RunIfSelected<CppTable>(options, workload, indices, keyLength, results);
+            RunIfSelected<CTable>(options, workload, indices, keyLength, results);
+            RunIfSelected<SwissTable>(options, workload, indices, keyLength, results);
+            RunIfSelected<RobinHoodTable>(options, workload, indices, keyLength, results);
+            RunIfSelected<StdTable>(options, workload, indices, keyLength, results);
+        }
+    }
+
+    if (options.csv)
+    {
+        PrintCsv(results);
+    }
+    else
+    {
+        PrintJson(results);
+    }
+
+    return sink == SIZE_MAX ? 1 : 0;
+}
@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <print>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "../cpp/src/hash_table.hpp"
+
+// Compares uint64 -> uint64 maps: the templated table with integer keys,
+// std::unordered_map, and the string table fed IDs formatted with
+// std::to_string the way integer-keyed callers had to before. Formatting
+// happens inside the timed loops, since those callers pay for it on every
+// operation.
+// Usage: integer_bench [count] [rounds]
+template <typename Fn>
+static double Measure(const std::vector<uint64_t> &keys, const size_t rounds, Fn &&fn)
+{
+    double best{};
+    for (size_t round = 0; round < rounds; ++round)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (const uint64_t key : keys)
+        {
+            fn(key);
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        const double seconds = std::chrono::duration<double>(end - start).count();
+        best = std::max(best, static_cast<double>(keys.size()) / seconds);
+    }
+
+    return best / 1e6;
+}
+
+static void Report(const std::string_view name, const double insert, const double hit, const double miss, const size_t found)
+{
+    std::println("{:<26} insert: {:>6.2f}  hit: {:>6.2f}  miss: {:>6.2f} Mops/s  (found {})", name, insert, hit, miss, found);
+}
+
+int32_t main(int32_t argc, char **argv)
+{
+    const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+    const size_t rounds = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5;
+
+    std::mt19937_64 rng(42);
+    std::vector<uint64_t> hits(count);
+    std::vector<uint64_t> misses(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        // Even IDs are stored and odd ones never are.
+        hits[i] = rng() & ~1ull;
+        misses[i] = rng() | 1ull;
+    }
+
+    std::println("keys: {}", count);
+
+    {
+        size_t found{};
+        BasicHashTable<uint64_t, uint64_t> table;
+        const double insert = Measure(hits, 1, [&](const uint64_t key) { table.Insert(key, key); });
+        const double hit = Measure(hits, rounds, [&](const uint64_t key) { found += table.Search(key) != nullptr; });
+        const double miss = Measure(misses, rounds, [&](const uint64_t key) { found += table.Search(key) != nullptr; });
+        Report("BasicHashTable<uint64_t>", insert, hit, miss, found);
+    }
+
+    {
+        size_t found{};
+        std::unordered_map<uint64_t, uint64_t> table;
+        const double insert = Measure(hits, 1, [&](const uint64_t key) { table.insert_or_assign(key, key); });
+        const double hit = Measure(hits, rounds, [&](const uint64_t key) { found += table.find(key) != table.end(); });
+        const double miss = Measure(misses, rounds, [&](const uint64_t key) { found += table.find(key) != table.end(); });
+        Report("std::unordered_map", insert, hit, miss, found);
+    }
+
+    {
+        size_t found{};
+        HashTable table;
+        const double insert = Measure(hits, 1, [&](const uint64_t key) {
+            const std::string id = std::to_string(key);
+            table.Insert(id, id);
+        });
+        const double hit = Measure(hits, rounds, [&](const uint64_t key) { found += table.Search(std::to_string(key)) != nullptr; });
+        const double miss = Measure(misses, rounds, [&](const uint64_t key) { found += table.Search(std::to_string(key)) != nullptr; });
+        Report("HashTable (to_string keys)", insert, hit, miss, found);
+    }
+
+    return 0;
+}
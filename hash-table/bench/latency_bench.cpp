@@ -0,0 +1,66 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <print>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../cpp/src/hash_table.hpp"
+
+// Times every Insert while a table grows from empty to `count` keys, then
+// every Delete while it shrinks back, and reports the latency percentiles.
+// Usage: latency_bench [count]
+static void Report(const std::string_view name, std::vector<uint64_t> &latencies)
+{
+    std::sort(latencies.begin(), latencies.end());
+    const auto percentile = [&](const double p) {
+        return latencies[static_cast<size_t>(p * (latencies.size() - 1))];
+    };
+
+    std::println("{:<24} p50: {:>6} ns  p99: {:>6} ns  p999: {:>8} ns  max: {:>10} ns",
+                 name, percentile(0.5), percentile(0.99), percentile(0.999), latencies.back());
+}
+
+static void Run(const std::string_view name, const ResizeMode mode, const std::vector<std::string> &keys)
+{
+    HashTable table(53, {.resizeMode = mode});
+    std::vector<uint64_t> latencies(keys.size());
+
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        table.Insert(keys[i], keys[i]);
+        const auto end = std::chrono::steady_clock::now();
+        latencies[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    }
+    Report(std::string(name) + " insert", latencies);
+
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        table.Delete(keys[i]);
+        const auto end = std::chrono::steady_clock::now();
+        latencies[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    }
+    Report(std::string(name) + " delete", latencies);
+}
+
+int32_t main(int32_t argc, char **argv)
+{
+    const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+
+    std::vector<std::string> keys;
+    keys.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        keys.push_back("key:" + std::to_string(i));
+    }
+
+    std::println("keys: {}", count);
+    Run("blocking", ResizeMode::Blocking, keys);
+    Run("incremental", ResizeMode::Incremental, keys);
+
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <print>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../cpp/src/hash_table.hpp"
+
+// Short base-36 keys, so the baseline polynomial hash can still be run
+// against the same key set without overflowing.
+static std::string MakeKey(size_t n)
+{
+    std::string key;
+    do
+    {
+        key.push_back("0123456789abcdefghijklmnopqrstuvwxyz"[n % 36]);
+        n /= 36;
+    } while (n != 0);
+    return key;
+}
+
+static void Run(const std::string_view name, const CapacityPolicy policy, std::vector<std::string> keys, const size_t rounds)
+{
+    HashTable table(53, {.capacityPolicy = policy});
+    for (const std::string &key : keys)
+    {
+        table.Insert(key, key);
+    }
+
+    std::mt19937_64 rng(42);
+    std::shuffle(keys.begin(), keys.end(), rng);
+
+    size_t found{};
+    double best{};
+    for (size_t round = 0; round < rounds; ++round)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (const std::string &key : keys)
+        {
+            found += table.Search(key) != nullptr;
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        const double seconds = std::chrono::duration<double>(end - start).count();
+        best = std::max(best, static_cast<double>(keys.size()) / seconds);
+    }
+
+    std::println("{:<12} size: {}, found: {}, lookups: {:.2f} Mops/s", name, table.GetSize(), found, best / 1e6);
+}
+
+// Measures HashTable::Search throughput on a table holding `count` keys,
+// once per capacity policy.
+// Usage: lookup_bench [count] [rounds]
+int32_t main(int32_t argc, char **argv)
+{
+    const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+    const size_t rounds = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5;
+
+    std::vector<std::string> keys;
+    keys.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        keys.push_back(MakeKey(i));
+    }
+
+    std::println("keys: {}", count);
+    Run("power of two", CapacityPolicy::PowerOfTwo, keys, rounds);
+    Run("prime", CapacityPolicy::Prime, keys, rounds);
+
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <print>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../cpp/src/hash_table.hpp"
+
+// Bulk-loads `keys` into a default-sized table, once letting it grow on its
+// own and once after a single Reserve, and reports the rebuilds each took.
+static void Load(const std::string_view name, const std::vector<std::string> &keys, const bool reserve)
+{
+    HashTable table;
+
+    const auto start = std::chrono::steady_clock::now();
+    if (reserve)
+    {
+        table.Reserve(keys.size());
+    }
+    for (const std::string &key : keys)
+    {
+        table.Insert(key, key);
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    const HashTableStats stats = table.GetStats();
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    std::println("{:<12} resizes: {:>2}, capacity: {}, load: {:.2f} Mops/s",
+                 name, stats.resizes, stats.capacity, static_cast<double>(keys.size()) / seconds / 1e6);
+}
+
+// Alternates inserting and deleting one key `rounds` times on a table that
+// has just grown. Before the hysteresis, and while Delete checked the load
+// before removing the key, such a table could shrink and grow back over and
+// over.
+static void Thrash(const size_t count, const size_t rounds)
+{
+    HashTable table;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const std::string key = "key:" + std::to_string(i);
+        table.Insert(key, key);
+    }
+    const size_t before = table.GetStats().resizes;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < rounds; ++i)
+    {
+        const std::string key = "thrash:" + std::to_string(i);
+        table.Insert(key, key);
+        table.Delete(key);
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    const HashTableStats stats = table.GetStats();
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    std::println("{:<12} resizes: {:>2}, compactions: {}, insert+delete: {:.2f} Mops/s",
+                 "thrash", stats.resizes - before, stats.compactions, static_cast<double>(rounds) / seconds / 1e6);
+}
+
+// Reserves room for count keys, fills a few and deletes one. Before deletes
+// respected the reservation, the table halved on that first delete and on
+// every one after it.
+static bool KeepsReservation(const size_t count)
+{
+    HashTable table;
+    table.Reserve(count);
+    const size_t capacity = table.GetStats().capacity;
+    for (size_t i = 0; i < 10; ++i)
+    {
+        const std::string key = "key:" + std::to_string(i);
+        table.Insert(key, key);
+    }
+    table.Delete("key:0");
+
+    const HashTableStats stats = table.GetStats();
+    std::println("{:<12} capacity: {} -> {}", "reserved", capacity, stats.capacity);
+    return stats.capacity == capacity;
+}
+
+// Usage: reserve_bench [count] [rounds]
+int32_t main(int32_t argc, char **argv)
+{
+    const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 5'000'000;
+    const size_t rounds = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1'000'000;
+
+    std::vector<std::string> keys;
+    keys.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        keys.push_back("key:" + std::to_string(i));
+    }
+
+    std::println("keys: {}", count);
+    Load("grow", keys, false);
+    Load("reserve", keys, true);
+    Thrash(46'000, rounds);
+
+    return KeepsReservation(count) ? 0 : 1;
+}
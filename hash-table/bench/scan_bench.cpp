@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <print>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "../cpp/src/hash_table.hpp"
+#include "../cpp/src/swiss_hash_table.hpp"
+
+static constexpr size_t MaxStripes = 64;
+
+// Times fn, which scans the whole table and returns the total value length
+// it saw, and reports entries visited per second.
+template <typename Fn>
+static void Measure(const std::string_view name, const size_t count, Fn &&fn)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const size_t bytes = fn();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::println("{:<20} {:>8.2f} Mentries/s  (value bytes: {})", name, static_cast<double>(count) / seconds / 1e6, bytes);
+}
+
+// Sums the value lengths of every entry, the shape of a periodic aggregation
+// job, by each way of scanning the tables.
+// Usage: scan_bench [count]
+int32_t main(int32_t argc, char **argv)
+{
+    const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4'000'000;
+
+    HashTable table;
+    SwissHashTable swiss;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const std::string key = "session:" + std::to_string(i);
+        table.Insert(key, std::to_string(i));
+        swiss.Insert(key, std::to_string(i));
+    }
+
+    std::println("keys: {}, HashTable capacity: {}, SwissHashTable capacity: {}", count, table.GetSize(), swiss.GetSize());
+
+    Measure("HashTable ForEach", count, [&] {
+        size_t bytes{};
+        table.ForEach([&](const std::pmr::string &, const std::pmr::string &value) { bytes += value.size(); });
+        return bytes;
+    });
+    Measure("HashTable iterator", count, [&] {
+        size_t bytes{};
+        for (const HashTableEntry &entry : table)
+        {
+            bytes += entry.value.size();
+        }
+        return bytes;
+    });
+    Measure("SwissHashTable iter", count, [&] {
+        size_t bytes{};
+        for (const HashTableEntry &entry : swiss)
+        {
+            bytes += entry.value.size();
+        }
+        return bytes;
+    });
+
+    const size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        Measure("ParallelForEach x" + std::to_string(threads), count, [&] {
+            // Each thread adds into a counter of its own cache line, so the
+            // numbers show the scan rather than contention on one counter.
+            struct alignas(64) Stripe
+            {
+                std::atomic<size_t> bytes;
+            };
+            static Stripe stripes[MaxStripes];
+            static std::atomic<size_t> nextStripe;
+            for (Stripe &stripe : stripes)
+            {
+                stripe.bytes = 0;
+            }
+
+            table.ParallelForEach([&](const std::pmr::string &, const std::pmr::string &value) {
+                thread_local const size_t stripe = nextStripe++ % MaxStripes;
+                stripes[stripe].bytes.fetch_add(value.size(), std::memory_order_relaxed);
+            }, threads);
+
+            size_t bytes{};
+            for (const Stripe &stripe : stripes)
+            {
+                bytes += stripe.bytes;
+            }
+            return bytes;
+        });
+    }
+
+    return 0;
+}
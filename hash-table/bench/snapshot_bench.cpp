@@ -0,0 +1,70 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <print>
+#include <string>
+#include <vector>
+
+#include "../cpp/src/hash_table.hpp"
+#include "../cpp/src/hash_table_snapshot.hpp"
+
+static double SecondsSince(const std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Compares the two ways of getting a table back after a restart: inserting
+// every key again, or mapping a snapshot saved before shutdown. Lookups are
+// then timed on both, the first pass over the mapping including its page
+// faults.
+// Usage: snapshot_bench [count] [path]
+int32_t main(int32_t argc, char **argv)
+{
+    const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2'000'000;
+    const std::filesystem::path path = argc > 2 ? argv[2] : "snapshot_bench.snap";
+
+    std::vector<std::string> keys;
+    keys.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        keys.push_back("session:" + std::to_string(i));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    HashTable table;
+    for (const std::string &key : keys)
+    {
+        table.Insert(key, key);
+    }
+    const double rebuild = SecondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    table.SaveSnapshot(path);
+    const double save = SecondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    const MappedHashTable mapped(path);
+    const double open = SecondsSince(start);
+
+    const auto lookups = [&](auto &&search) {
+        const auto begin = std::chrono::steady_clock::now();
+        size_t found{};
+        for (const std::string &key : keys)
+        {
+            found += search(key);
+        }
+        return std::pair{found, static_cast<double>(keys.size()) / SecondsSince(begin) / 1e6};
+    };
+    const auto [coldFound, cold] = lookups([&](const std::string &key) { return mapped.Search(key).has_value(); });
+    const auto [warmFound, warm] = lookups([&](const std::string &key) { return mapped.Search(key).has_value(); });
+    const auto [tableFound, inMemory] = lookups([&](const std::string &key) { return table.Search(key) != nullptr; });
+
+    std::println("keys: {}, snapshot: {} MiB", count, std::filesystem::file_size(path) >> 20);
+    std::println("rebuild by insert: {:.3f} s, save: {:.3f} s, open mapped: {:.6f} s", rebuild, save, open);
+    std::println("lookups  mapped cold: {:.2f}  mapped warm: {:.2f}  HashTable: {:.2f} Mops/s", cold, warm, inMemory);
+    std::println("found: {} / {} / {}, verify: {}", coldFound, warmFound, tableFound, mapped.Verify());
+
+    std::filesystem::remove(path);
+    return 0;
+}
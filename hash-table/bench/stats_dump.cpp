@@ -0,0 +1,57 @@
+#include <cstdint>
+#include <fstream>
+#include <print>
+#include <string>
+#include <vector>
+
+#include "../cpp/src/hash_table.hpp"
+
+#ifndef HASH_TABLE_STATS
+#error "stats_dump needs the instrumentation: build it with -DHASH_TABLE_STATS"
+#endif
+
+// Loads keys (one per line, or generated ones when no file is given) into a
+// HashTable, looks every one of them up once as a hit and once as a miss,
+// deletes half, and prints the table's stats as JSON. Long tails in the probe
+// histograms mean the hash clusters on these keys.
+// Usage: stats_dump [keyfile] > stats.json
+int32_t main(int32_t argc, char **argv)
+{
+    std::vector<std::string> keys;
+    if (argc > 1)
+    {
+        std::ifstream file(argv[1]);
+        for (std::string line; std::getline(file, line);)
+        {
+            keys.push_back(line);
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < 1'000'000; ++i)
+        {
+            keys.push_back("key:" + std::to_string(i));
+        }
+    }
+
+    HashTable table;
+    for (const std::string &key : keys)
+    {
+        table.Insert(key, key);
+    }
+
+    for (const std::string &key : keys)
+    {
+        table.Search(key);
+        table.Search(key + '\x01');
+    }
+
+    for (size_t i = 0; i < keys.size(); i += 2)
+    {
+        table.Delete(keys[i]);
+    }
+
+    std::println("{}", ToJson(table.GetStats()));
+
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <print>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../cpp/src/hash_table.hpp"
+#include "../cpp/src/swiss_hash_table.hpp"
+
+// Compares HashTable and SwissHashTable lookups on a hit-heavy workload (all
+// probed keys present) and a miss-heavy one (none present).
+// Usage: swiss_bench [count] [rounds]
+template <typename Table>
+static double MeasureLookups(Table &table, const std::vector<std::string> &keys, const size_t rounds)
+{
+    size_t found{};
+    double best{};
+    for (size_t round = 0; round < rounds; ++round)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (const std::string &key : keys)
+        {
+            found += table.Search(key) != nullptr;
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        const double seconds = std::chrono::duration<double>(end - start).count();
+        best = std::max(best, static_cast<double>(keys.size()) / seconds);
+    }
+
+    // Keeps the lookups from being optimized away.
+    if (found == SIZE_MAX)
+    {
+        std::println("unreachable");
+    }
+
+    return best / 1e6;
+}
+
+template <typename Table>
+static void Run(const std::string_view name, const std::vector<std::string> &hits, const std::vector<std::string> &misses, const size_t rounds)
+{
+    Table table;
+    for (const std::string &key : hits)
+    {
+        table.Insert(key, key);
+    }
+
+    std::println("{:<16} hit: {:.2f} Mops/s  miss: {:.2f} Mops/s",
+                 name, MeasureLookups(table, hits, rounds), MeasureLookups(table, misses, rounds));
+}
+
+int32_t main(int32_t argc, char **argv)
+{
+    const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+    const size_t rounds = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5;
+
+    std::vector<std::string> hits;
+    std::vector<std::string> misses;
+    hits.reserve(count);
+    misses.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        hits.push_back("key:" + std::to_string(i));
+        misses.push_back("miss:" + std::to_string(i));
+    }
+
+    std::mt19937_64 rng(42);
+    std::shuffle(hits.begin(), hits.end(), rng);
+
+    std::println("keys: {}", count);
+    Run<HashTable>("HashTable", hits, misses, rounds);
+    Run<SwissHashTable>("SwissHashTable", hits, misses, rounds);
+
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+#define ARENA_MIN_BLOCK 16
+#define ARENA_CLASS_COUNT (sizeof(((arena_t *)0)->free_lists) / sizeof(arena_block_t *))
+#define ARENA_MAX_BLOCK ((size_t)ARENA_MIN_BLOCK << (ARENA_CLASS_COUNT - 1))
+
+// Blocks are rounded up to a power of two from 16 bytes to 4 KiB.
+static size_t size_class(const size_t size)
+{
+    size_t class = 0;
+    while (((size_t)ARENA_MIN_BLOCK << class) < size)
+    {
+        ++class;
+    }
+
+    return class;
+}
+
+arena_t *create_arena(const size_t chunk_size)
+{
+    arena_t *arena = malloc(sizeof(arena_t));
+    memset(arena, 0, sizeof(arena_t));
+    arena->chunk_size = chunk_size < ARENA_MAX_BLOCK ? ARENA_MAX_BLOCK : chunk_size;
+    return arena;
+}
+
+void delete_arena(arena_t *arena)
+{
+    arena_block_t *lists[] = {arena->chunks, arena->large_blocks};
+    for (size_t i = 0; i < sizeof(lists) / sizeof(lists[0]); ++i)
+    {
+        arena_block_t *block = lists[i];
+        while (block != NULL)
+        {
+            arena_block_t *next = block->next;
+            free(block);
+            block = next;
+        }
+    }
+
+    free(arena);
+}
+
+void *arena_alloc(arena_t *arena, const size_t size)
+{
+    if (size > ARENA_MAX_BLOCK)
+    {
+        // Large blocks are allocated on their own behind a list header, which
+        // keeps them 16-byte aligned and reachable from delete_arena.
+        arena_block_t *block = malloc(sizeof(arena_block_t) + size);
+        block->prev = NULL;
+        block->next = arena->large_blocks;
+        if (arena->large_blocks != NULL)
+        {
+            arena->large_blocks->prev = block;
+        }
+        arena->large_blocks = block;
+        return block + 1;
+    }
+
+    const size_t class = size_class(size);
+    arena_block_t *block = arena->free_lists[class];
+    if (block != NULL)
+    {
+        arena->free_lists[class] = block->next;
+        return block;
+    }
+
+    const size_t block_size = (size_t)ARENA_MIN_BLOCK << class;
+    if ((size_t)(arena->end - arena->cursor) < block_size)
+    {
+        // Chunks are chained through a header at their start; the tail of the
+        // previous chunk is abandoned.
+        arena_block_t *chunk = malloc(sizeof(arena_block_t) + arena->chunk_size);
+        chunk->prev = NULL;
+        chunk->next = arena->chunks;
+        arena->chunks = chunk;
+        arena->cursor = (char *)(chunk + 1);
+        arena->end = arena->cursor + arena->chunk_size;
+    }
+
+    void *result = arena->cursor;
+    arena->cursor += block_size;
+    return result;
+}
+
+void arena_free(arena_t *arena, void *block, const size_t size)
+{
+    if (size > ARENA_MAX_BLOCK)
+    {
+        arena_block_t *large = (arena_block_t *)block - 1;
+        if (large->prev != NULL)
+        {
+            large->prev->next = large->next;
+        }
+        else
+        {
+            arena->large_blocks = large->next;
+        }
+        if (large->next != NULL)
+        {
+            large->next->prev = large->prev;
+        }
+        free(large);
+        return;
+    }
+
+    const size_t class = size_class(size);
+    arena_block_t *free_block = block;
+    free_block->next = arena->free_lists[class];
+    arena->free_lists[class] = free_block;
+}
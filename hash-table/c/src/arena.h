@@ -0,0 +1,30 @@
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <stddef.h>
+
+typedef struct arena_block_t
+{
+    struct arena_block_t *prev;
+    struct arena_block_t *next;
+} arena_block_t;
+
+// Bump allocator over large chunks. Freed blocks go onto per-size-class free
+// lists and are handed out again; the chunks are only released by
+// delete_arena, together with any block that was never freed.
+typedef struct
+{
+    size_t chunk_size;
+    char *cursor;
+    char *end;
+    arena_block_t *chunks;
+    arena_block_t *large_blocks;
+    arena_block_t *free_lists[9];
+} arena_t;
+
+arena_t *create_arena(const size_t chunk_size);
+void delete_arena(arena_t *arena);
+void *arena_alloc(arena_t *arena, const size_t size);
+void arena_free(arena_t *arena, void *block, const size_t size);
+
+#endif
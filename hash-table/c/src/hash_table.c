@@ -1,47 +1,171 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
-#include <math.h>
 
+#include "arena.h"
 #include "hash_table.h"
 #include "prime.h"
 
-static hash_table_item_t DELETED_ITEM = {NULL, NULL};
+static hash_table_item_t DELETED_ITEM = {NULL, NULL, 0, 0, 0, 0};
 
-static hash_table_item_t *create_item(const char *key, const char *value)
+#define ARENA_CHUNK_SIZE (1 << 20)
+#define ITEM_ALIGNMENT 16
+
+// The item, key and value share one block. Blocks are rounded up to
+// ITEM_ALIGNMENT, and the rounding goes to the value, so slightly longer
+// values still fit in place.
+static size_t item_block_size(const size_t key_length, const size_t value_capacity)
+{
+    return sizeof(hash_table_item_t) + key_length + 1 + value_capacity + 1;
+}
+
+static hash_table_item_t *create_item(hash_table_t *table, const void *key, const size_t key_length, const void *value, const size_t value_length, const uint64_t key_hash)
 {
-    hash_table_item_t *item = malloc(sizeof(hash_table_item_t));
-    item->key = strdup(key);
-    item->value = strdup(value);
+    const size_t size = (item_block_size(key_length, value_length) + ITEM_ALIGNMENT - 1) & ~(size_t)(ITEM_ALIGNMENT - 1);
+    hash_table_item_t *item = table->arena != NULL ? arena_alloc(table->arena, size) : malloc(size);
+
+    item->key = (char *)(item + 1);
+    item->value = item->key + key_length + 1;
+    item->key_length = key_length;
+    item->value_length = value_length;
+    item->value_capacity = size - item_block_size(key_length, 0);
+    item->hash = key_hash;
+
+    memcpy(item->key, key, key_length);
+    item->key[key_length] = '\0';
+    memcpy(item->value, value, value_length);
+    item->value[value_length] = '\0';
     return item;
 }
 
-static void delete_item(hash_table_item_t *item)
+static void delete_item(hash_table_t *table, hash_table_item_t *item)
+{
+    if (table->arena == NULL)
+    {
+        free(item);
+        return;
+    }
+
+    arena_free(table->arena, item, item_block_size(item->key_length, item->value_capacity));
+}
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+static const uint64_t HASH_SECRET[4] = {
+    0xa0761d6478bd642fULL,
+    0xe7037ed1a0b428dbULL,
+    0x8ebc6af09c88c6e3ULL,
+    0x589965cc75374cc3ULL,
+};
+
+static void hash_multiply(uint64_t *a, uint64_t *b)
 {
-    free(item->key);
-    free(item->value);
-    free(item);
+#if defined(__SIZEOF_INT128__)
+    const unsigned __int128 r = (unsigned __int128)*a * *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    *a = _umul128(*a, *b, b);
+#else
+    const uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+    const uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    const uint64_t t = rl + (rm0 << 32);
+    uint64_t c = t < rl;
+    const uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
 }
 
-static int32_t hash(const char *str, const int32_t prime, const int32_t mod)
+static uint64_t hash_mix(uint64_t a, uint64_t b)
 {
-    int64_t hash = 0LL;
-    const int32_t length = strlen(str);
+    hash_multiply(&a, &b);
+    return a ^ b;
+}
 
-    for (int32_t i = 0; i < length; ++i)
+static uint64_t read8(const uint8_t *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint64_t read4(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// wyhash-style 64-bit string hash, computed once per item and cached in it.
+uint64_t hash_table_default_hash(const void *key, const size_t length)
+{
+    const uint8_t *p = (const uint8_t *)key;
+    uint64_t seed = hash_mix(HASH_SECRET[0], HASH_SECRET[1]);
+    uint64_t a;
+    uint64_t b;
+
+    if (length <= 16)
     {
-        hash += (int64_t)pow(prime, length - (i + 1)) * str[i];
+        if (length >= 4)
+        {
+            a = (read4(p) << 32) | read4(p + ((length >> 3) << 2));
+            b = (read4(p + length - 4) << 32) | read4(p + length - 4 - ((length >> 3) << 2));
+        }
+        else if (length > 0)
+        {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[length >> 1] << 8) | p[length - 1];
+            b = 0;
+        }
+        else
+        {
+            a = b = 0;
+        }
+    }
+    else
+    {
+        size_t i = length;
+        if (i > 48)
+        {
+            uint64_t see1 = seed;
+            uint64_t see2 = seed;
+            do
+            {
+                seed = hash_mix(read8(p) ^ HASH_SECRET[1], read8(p + 8) ^ seed);
+                see1 = hash_mix(read8(p + 16) ^ HASH_SECRET[2], read8(p + 24) ^ see1);
+                see2 = hash_mix(read8(p + 32) ^ HASH_SECRET[3], read8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+
+        while (i > 16)
+        {
+            seed = hash_mix(read8(p) ^ HASH_SECRET[1], read8(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+
+        a = read8(p + i - 16);
+        b = read8(p + i - 8);
     }
-    hash = hash % mod;
 
-    return (int32_t)hash;
+    a ^= HASH_SECRET[1];
+    b ^= seed;
+    hash_multiply(&a, &b);
+    return hash_mix(a ^ HASH_SECRET[0] ^ length, b ^ HASH_SECRET[1]);
 }
 
-static int32_t double_hash(const char *str, const int32_t num_buckets, const int32_t attempt)
+// Double hashing: the low half picks the home bucket, the high half the step.
+static int32_t double_hash(const uint64_t hash, const int32_t num_buckets, const int32_t attempt)
 {
-    const int32_t hash_a = hash(str, 131, num_buckets);
-    const int32_t hash_b = hash(str, 137, num_buckets - 1);
-    return (hash_a + (attempt * (hash_b + 1))) % num_buckets;
+    const uint64_t hash_a = hash % (uint64_t)num_buckets;
+    const uint64_t hash_b = (hash >> 32) % (uint64_t)(num_buckets - 1);
+    return (int32_t)((hash_a + (uint64_t)attempt * (hash_b + 1)) % (uint64_t)num_buckets);
 }
 
 hash_table_t *create_hash_table(const int32_t size)
@@ -50,18 +174,37 @@ hash_table_t *create_hash_table(const int32_t size)
     table->base_size = size;
     table->size = next_prime(size);
     table->count = 0;
+    table->deleted = 0;
     table->items = calloc((size_t)table->size, sizeof(hash_table_item_t *));
+    table->arena = NULL;
+    table->hash = NULL;
+    table->equal = NULL;
+    return table;
+}
+
+hash_table_t *create_arena_hash_table(const int32_t size)
+{
+    hash_table_t *table = create_hash_table(size);
+    table->arena = create_arena(ARENA_CHUNK_SIZE);
     return table;
 }
 
 void delete_hash_table(hash_table_t *table)
 {
-    for (int32_t i = 0; i < table->size; ++i)
+    if (table->arena != NULL)
     {
-        hash_table_item_t *item = table->items[i];
-        if (item != NULL && item != &DELETED_ITEM)
+        // Every item lives in the arena, so its chunks are all there is to free.
+        delete_arena(table->arena);
+    }
+    else
+    {
+        for (int32_t i = 0; i < table->size; ++i)
         {
-            delete_item(item);
+            hash_table_item_t *item = table->items[i];
+            if (item != NULL && item != &DELETED_ITEM)
+            {
+                delete_item(table, item);
+            }
         }
     }
 
@@ -71,117 +214,218 @@ void delete_hash_table(hash_table_t *table)
 
 static void resize_hash_table(hash_table_t *table, const int32_t size)
 {
-    if (size < 53)
+    // Shrinking stops at 53 slots. Growing and same-size rebuilds always go
+    // ahead, and bring a table created smaller than that up to it.
+    if (size < table->size && table->size <= 53)
     {
         return;
     }
 
-    hash_table_t *new_table = create_hash_table(size);
+    const int32_t base_size = size < 53 ? 53 : size;
+    const int32_t new_size = next_prime(base_size);
+    hash_table_item_t **items = calloc((size_t)new_size, sizeof(hash_table_item_t *));
+
+    // Items are relinked into the new array as they are, so no key or value is
+    // copied again and tombstones are dropped along the way.
     for (int32_t i = 0; i < table->size; ++i)
     {
         hash_table_item_t *item = table->items[i];
-        if (item != NULL && item != &DELETED_ITEM)
+        if (item == NULL || item == &DELETED_ITEM)
         {
-            hash_table_insert(new_table, item->key, item->value);
+            continue;
         }
-    }
-
-    table->base_size = new_table->base_size;
-    table->count = new_table->count;
-
-    const int32_t temp_size = table->size;
-    table->size = new_table->size;
-    new_table->size = temp_size;
 
-    hash_table_item_t **temp_items = table->items;
-    table->items = new_table->items;
-    new_table->items = temp_items;
+        int32_t index = double_hash(item->hash, new_size, 0);
+        for (int32_t attempt = 1; items[index] != NULL; ++attempt)
+        {
+            index = double_hash(item->hash, new_size, attempt);
+        }
+        items[index] = item;
+    }
 
-    delete_hash_table(new_table);
+    free(table->items);
+    table->items = items;
+    table->base_size = base_size;
+    table->size = new_size;
+    table->deleted = 0;
 }
 
+// Both directions start from the actual size rather than the requested base
+// size, which next_prime may have rounded well up. A grown table lands at
+// about 35% load and a shrunk one at about 40%, clear of both thresholds.
 static void resize_up_hash_table(hash_table_t *table)
 {
-    resize_hash_table(table, table->base_size * 2);
+    resize_hash_table(table, table->size * 2);
 }
 
 static void resize_down_hash_table(hash_table_t *table)
 {
-    resize_hash_table(table, table->base_size / 2);
+    resize_hash_table(table, table->size / 2);
 }
 
-void hash_table_insert(hash_table_t *table, const char *key, const char *value)
+int32_t hash_table_set_callbacks(hash_table_t *table, const hash_table_hash_t hash, const hash_table_equal_t equal)
 {
-    const int32_t load = table->count * 100 / table->size;
-    if (load > 70)
+    // Items already stored carry hashes from the old function.
+    if (table->count != 0)
     {
-        resize_up_hash_table(table);
+        return -1;
     }
 
-    hash_table_item_t *item = create_item(key, value);
-    int32_t index = double_hash(key, table->size, 0);
-    hash_table_item_t *cur_item = table->items[index];
+    table->hash = hash;
+    table->equal = equal;
+    return 0;
+}
 
-    int32_t i = 1;
-    while (cur_item != NULL)
+static uint64_t hash_key(const hash_table_t *table, const void *key, const size_t key_length)
+{
+    return table->hash != NULL ? table->hash(key, key_length) : hash_table_default_hash(key, key_length);
+}
+
+// The cached hash rules out almost every other key before the comparison.
+static int32_t item_matches(const hash_table_t *table, const hash_table_item_t *item, const void *key, const size_t key_length, const uint64_t key_hash)
+{
+    if (item == &DELETED_ITEM || item->hash != key_hash)
     {
-        if (cur_item != &DELETED_ITEM && strcmp(cur_item->key, key) == 0)
+        return 0;
+    }
+
+    if (table->equal != NULL)
+    {
+        return table->equal(item->key, item->key_length, key, key_length) != 0;
+    }
+
+    return item->key_length == key_length && memcmp(item->key, key, key_length) == 0;
+}
+
+// Returns the index of the item holding key, or -1. If insert_index is not
+// NULL it receives where a new item for key belongs: the first tombstone on
+// the probe path, otherwise the empty slot that ended it.
+static int32_t find_index(const hash_table_t *table, const void *key, const size_t key_length, const uint64_t key_hash, int32_t *insert_index)
+{
+    int32_t index = double_hash(key_hash, table->size, 0);
+    int32_t tombstone = -1;
+
+    for (int32_t i = 1; table->items[index] != NULL; ++i)
+    {
+        const hash_table_item_t *item = table->items[index];
+        if (item_matches(table, item, key, key_length, key_hash))
         {
-            delete_item(cur_item);
-            table->items[index] = item;
-            return;
+            return index;
         }
-        index = double_hash(key, table->size, i++);
-        cur_item = table->items[index];
+
+        if (item == &DELETED_ITEM && tombstone < 0)
+        {
+            tombstone = index;
+        }
+
+        index = double_hash(key_hash, table->size, i);
     }
 
-    table->items[index] = item;
-    ++table->count;
+    if (insert_index != NULL)
+    {
+        *insert_index = tombstone >= 0 ? tombstone : index;
+    }
+    return -1;
 }
 
-char *hash_table_search(hash_table_t *table, const char *key)
+void hash_table_insert_n(hash_table_t *table, const void *key, const size_t key_length, const void *value, const size_t value_length)
 {
-    int32_t index = double_hash(key, table->size, 0);
-    hash_table_item_t *item = table->items[index];
+    const uint64_t key_hash = hash_key(table, key, key_length);
+    int32_t insert_index;
+    const int32_t index = find_index(table, key, key_length, key_hash, &insert_index);
 
-    int32_t i = 1;
-    while (item != NULL)
+    if (index >= 0)
     {
-        if (item != &DELETED_ITEM && strcmp(item->key, key) == 0)
+        hash_table_item_t *item = table->items[index];
+        if (value_length <= item->value_capacity)
+        {
+            // memmove, since the new value may be a view into the old one.
+            memmove(item->value, value, value_length);
+            item->value[value_length] = '\0';
+            item->value_length = value_length;
+            return;
+        }
+
+        table->items[index] = create_item(table, item->key, key_length, value, value_length, key_hash);
+        delete_item(table, item);
+        return;
+    }
+
+    // Tombstones end no probe, so they count towards the load. When they
+    // make up most of it the table is rebuilt at the same size instead;
+    // without this, insert/delete churn fills every free slot with them and
+    // probes for absent keys never terminate. Updates above leave the load
+    // as it is and never resize.
+    const int64_t load = ((int64_t)table->count + table->deleted) * 100 / table->size;
+    if (load > 70)
+    {
+        if ((int64_t)table->count * 100 / table->size > 35)
+        {
+            resize_up_hash_table(table);
+        }
+        else
         {
-            return item->value;
+            resize_hash_table(table, table->size);
         }
 
-        index = double_hash(key, table->size, i++);
-        item = table->items[index];
+        find_index(table, key, key_length, key_hash, &insert_index);
     }
 
-    return NULL;
+    if (table->items[insert_index] == &DELETED_ITEM)
+    {
+        --table->deleted;
+    }
+    table->items[insert_index] = create_item(table, key, key_length, value, value_length, key_hash);
+    ++table->count;
 }
 
-void hash_table_delete(hash_table_t *table, const char *key)
+char *hash_table_search_n(hash_table_t *table, const void *key, const size_t key_length, size_t *value_length)
 {
-    const int32_t load = table->count * 100 / table->size;
-    if (load < 30)
+    const int32_t index = find_index(table, key, key_length, hash_key(table, key, key_length), NULL);
+    if (index < 0)
     {
-        resize_down_hash_table(table);
+        return NULL;
     }
 
-    int32_t index = double_hash(key, table->size, 0);
     hash_table_item_t *item = table->items[index];
+    if (value_length != NULL)
+    {
+        *value_length = item->value_length;
+    }
+    return item->value;
+}
 
-    int32_t i = 1;
-    while (item != NULL)
+void hash_table_delete_n(hash_table_t *table, const void *key, const size_t key_length)
+{
+    const int32_t index = find_index(table, key, key_length, hash_key(table, key, key_length), NULL);
+    if (index < 0)
     {
-        if (item != &DELETED_ITEM && strcmp(item->key, key) == 0)
-        {
-            delete_item(item);
-            table->items[index] = &DELETED_ITEM;
-            --table->count;
-            return;
-        }
+        return;
+    }
 
-        index = double_hash(key, table->size, i++);
-        item = table->items[index];
+    delete_item(table, table->items[index]);
+    table->items[index] = &DELETED_ITEM;
+    --table->count;
+    ++table->deleted;
+
+    // Checked after the removal, against the items that are left.
+    if ((int64_t)table->count * 100 / table->size < 20)
+    {
+        resize_down_hash_table(table);
     }
+}
+
+void hash_table_insert(hash_table_t *table, const char *key, const char *value)
+{
+    hash_table_insert_n(table, key, strlen(key), value, strlen(value));
+}
+
+char *hash_table_search(hash_table_t *table, const char *key)
+{
+    return hash_table_search_n(table, key, strlen(key), NULL);
+}
+
+void hash_table_delete(hash_table_t *table, const char *key)
+{
+    hash_table_delete_n(table, key, strlen(key));
 }
\ No newline at end of file
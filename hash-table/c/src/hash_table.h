@@ -1,24 +1,60 @@
 #ifndef HASH_TABLE_H_
 #define HASH_TABLE_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
+#include "arena.h"
+
+// Keys and values are byte strings of any content. Both are stored with a
+// NUL after them, so string keys and values can be used as C strings.
 typedef struct
 {
     char *key;
     char *value;
+    size_t key_length;
+    size_t value_length;
+    // Longest value the item holds without reallocating, not counting the NUL.
+    size_t value_capacity;
+    uint64_t hash; // cached so probes and resizes never rehash the key
 } hash_table_item_t;
 
+// Hashes length bytes at key. Keys that compare equal must hash equally.
+typedef uint64_t (*hash_table_hash_t)(const void *key, const size_t length);
+// Returns nonzero if the two keys are equal.
+typedef int32_t (*hash_table_equal_t)(const void *a, const size_t a_length, const void *b, const size_t b_length);
+
 typedef struct
 {
     int32_t base_size;
     int32_t size;
     int32_t count;
+    int32_t deleted; // tombstones left in items by hash_table_delete
     hash_table_item_t **items;
+    arena_t *arena; // NULL when items come from malloc
+    hash_table_hash_t hash; // NULL for hash_table_default_hash
+    hash_table_equal_t equal; // NULL for a byte-wise comparison
 } hash_table_t;
 
 hash_table_t *create_hash_table(const int32_t size);
+// Same table, but items are carved out of a table-owned arena, and
+// delete_hash_table frees the arena's chunks instead of the items.
+hash_table_t *create_arena_hash_table(const int32_t size);
 void delete_hash_table(hash_table_t *table);
+// Replaces the hash and key comparison; NULL keeps the default for either.
+// Only allowed while the table is empty. Returns 0 on success, -1 otherwise.
+int32_t hash_table_set_callbacks(hash_table_t *table, const hash_table_hash_t hash, const hash_table_equal_t equal);
+uint64_t hash_table_default_hash(const void *key, const size_t length);
+
+// Each item is a single allocation holding the key and value. Updating an
+// existing key copies the value into place without allocating, as long as
+// it is no longer than the item's value_capacity.
+void hash_table_insert_n(hash_table_t *table, const void *key, const size_t key_length, const void *value, const size_t value_length);
+// Returns NULL if key is absent. value_length may be NULL.
+char *hash_table_search_n(hash_table_t *table, const void *key, const size_t key_length, size_t *value_length);
+void hash_table_delete_n(hash_table_t *table, const void *key, const size_t key_length);
+
+// NUL-terminated forms of the above.
 void hash_table_insert(hash_table_t *table, const char *key, const char *value);
 char *hash_table_search(hash_table_t *table, const char *key);
 void hash_table_delete(hash_table_t *table, const char *key);
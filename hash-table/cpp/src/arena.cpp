@@ -0,0 +1,114 @@
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+
+#include "arena.hpp"
+
+ArenaResource::ArenaResource(const size_t chunkSize)
+{
+    chunkSize_ = chunkSize < MaxBlockSize ? MaxBlockSize : chunkSize;
+    cursor_ = nullptr;
+    end_ = nullptr;
+    largeBlocks_ = nullptr;
+    for (FreeBlock *&list : freeLists_)
+    {
+        list = nullptr;
+    }
+}
+
+ArenaResource::~ArenaResource()
+{
+    for (std::byte *chunk : chunks_)
+    {
+        ::operator delete(chunk);
+    }
+
+    while (largeBlocks_ != nullptr)
+    {
+        LargeBlock *next = largeBlocks_->next;
+        ::operator delete(largeBlocks_);
+        largeBlocks_ = next;
+    }
+}
+
+void *ArenaResource::do_allocate(size_t bytes, size_t alignment)
+{
+    if (alignment > MinBlockSize)
+    {
+        throw std::bad_alloc();
+    }
+
+    if (bytes > MaxBlockSize)
+    {
+        // The header keeps the block MinBlockSize-aligned and lets the
+        // destructor find blocks that were never deallocated.
+        static_assert(sizeof(LargeBlock) == MinBlockSize);
+        LargeBlock *block = static_cast<LargeBlock *>(::operator new(sizeof(LargeBlock) + bytes));
+        block->prev = nullptr;
+        block->next = largeBlocks_;
+        if (largeBlocks_ != nullptr)
+        {
+            largeBlocks_->prev = block;
+        }
+        largeBlocks_ = block;
+        return block + 1;
+    }
+
+    const size_t sizeClass = SizeClass(bytes);
+    if (FreeBlock *block = freeLists_[sizeClass])
+    {
+        freeLists_[sizeClass] = block->next;
+        return block;
+    }
+
+    const size_t blockSize = MinBlockSize << sizeClass;
+    if (static_cast<size_t>(end_ - cursor_) < blockSize)
+    {
+        // The tail of the previous chunk is abandoned; it is smaller than
+        // the block being asked for and at most MaxBlockSize bytes.
+        std::byte *chunk = static_cast<std::byte *>(::operator new(chunkSize_));
+        chunks_.push_back(chunk);
+        cursor_ = chunk;
+        end_ = chunk + chunkSize_;
+    }
+
+    void *block = cursor_;
+    cursor_ += blockSize;
+    return block;
+}
+
+void ArenaResource::do_deallocate(void *p, size_t bytes, size_t)
+{
+    if (bytes > MaxBlockSize)
+    {
+        LargeBlock *block = static_cast<LargeBlock *>(p) - 1;
+        if (block->prev != nullptr)
+        {
+            block->prev->next = block->next;
+        }
+        else
+        {
+            largeBlocks_ = block->next;
+        }
+        if (block->next != nullptr)
+        {
+            block->next->prev = block->prev;
+        }
+        ::operator delete(block);
+        return;
+    }
+
+    const size_t sizeClass = SizeClass(bytes);
+    FreeBlock *block = static_cast<FreeBlock *>(p);
+    block->next = freeLists_[sizeClass];
+    freeLists_[sizeClass] = block;
+}
+
+size_t ArenaResource::SizeClass(const size_t bytes)
+{
+    // Rounds up to the next power of two, starting at MinBlockSize.
+    const size_t rounded = std::bit_ceil(bytes < MinBlockSize ? MinBlockSize : bytes);
+    return std::countr_zero(rounded) - std::countr_zero(MinBlockSize);
+}
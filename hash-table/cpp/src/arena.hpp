@@ -0,0 +1,56 @@
+#ifndef ARENA_HPP_
+#define ARENA_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+// Memory resource that bump-allocates out of large chunks. Freed blocks go
+// onto per-size-class free lists and are reused by later allocations of the
+// same class; chunk memory is only returned when the arena is destroyed.
+// Blocks larger than the biggest size class get their own allocation but are
+// still owned by the arena, so destroying it releases everything at once.
+class ArenaResource : public std::pmr::memory_resource
+{
+public:
+    ArenaResource() : ArenaResource(DefaultChunkSize) {}
+    explicit ArenaResource(const size_t chunkSize);
+    ArenaResource(const ArenaResource &) = delete;
+    ArenaResource &operator=(const ArenaResource &) = delete;
+    ~ArenaResource();
+
+    size_t GetChunkCount() const { return chunks_.size(); }
+
+private:
+    struct FreeBlock
+    {
+        FreeBlock *next;
+    };
+
+    struct LargeBlock
+    {
+        LargeBlock *prev;
+        LargeBlock *next;
+    };
+
+    void *do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+    static size_t SizeClass(const size_t bytes);
+
+    static const size_t DefaultChunkSize = 1 << 20;
+    static const size_t MinBlockSize = 16;
+    static const size_t ClassCount = 9; // 16 bytes up to 4 KiB
+    static const size_t MaxBlockSize = MinBlockSize << (ClassCount - 1);
+
+    size_t chunkSize_;
+    std::vector<std::byte *> chunks_;
+    std::byte *cursor_;
+    std::byte *end_;
+    FreeBlock *freeLists_[ClassCount];
+    LargeBlock *largeBlocks_;
+};
+
+#endif
@@ -0,0 +1,59 @@
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+
+#include "concurrent_hash_table.hpp"
+#include "hash_table.hpp"
+
+ConcurrentHashTable::ConcurrentHashTable(const size_t shardCount, const HashTableOptions &options)
+{
+    shards_.resize(std::max<size_t>(shardCount, 1));
+    for (std::unique_ptr<Shard> &shard : shards_)
+    {
+        shard = std::make_unique<Shard>(options);
+    }
+}
+
+void ConcurrentHashTable::Insert(const std::string_view key, const std::string_view value)
+{
+    Shard &shard = ShardFor(key);
+    std::unique_lock lock(shard.mutex);
+    shard.table.Insert(key, value);
+}
+
+std::optional<std::string> ConcurrentHashTable::Search(const std::string_view key) const
+{
+    const Shard &shard = ShardFor(key);
+    std::shared_lock lock(shard.mutex);
+
+    // The const lookup never advances a migration, so readers can share it.
+    const HashTable &table = shard.table;
+    const HashTable::Value *value = table.Search(key);
+    if (value == nullptr)
+    {
+        return std::nullopt;
+    }
+
+    return std::string(*value);
+}
+
+void ConcurrentHashTable::Delete(const std::string_view key)
+{
+    Shard &shard = ShardFor(key);
+    std::unique_lock lock(shard.mutex);
+    shard.table.Delete(key);
+}
+
+ConcurrentHashTable::Shard &ConcurrentHashTable::ShardFor(const std::string_view key) const
+{
+    // Multiply-shift on the top 32 bits maps the hash onto [0, shards) without
+    // a division and independently of the low bits the shard probes with.
+    const uint64_t hash = hash_(key);
+    const size_t index = ((hash >> 32) * shards_.size()) >> 32;
+    return *shards_[index];
+}
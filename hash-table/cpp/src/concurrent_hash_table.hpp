@@ -0,0 +1,51 @@
+#ifndef CONCURRENT_HASH_TABLE_HPP_
+#define CONCURRENT_HASH_TABLE_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "hash.hpp"
+#include "hash_table.hpp"
+
+// Thread-safe table that splits the key space across independently locked
+// HashTable shards. The top bits of the key's hash pick the shard, so shards
+// stay balanced while the low bits remain free for probing inside each one.
+// Readers take the shard's lock shared; Insert/Delete and any resize they
+// trigger only hold their own shard exclusively.
+class ConcurrentHashTable
+{
+public:
+    ConcurrentHashTable() : ConcurrentHashTable(DefaultShardCount) {}
+    ConcurrentHashTable(const size_t shardCount, const HashTableOptions &options = {});
+
+    void Insert(const std::string_view key, const std::string_view value);
+    std::optional<std::string> Search(const std::string_view key) const;
+    void Delete(const std::string_view key);
+    size_t GetShardCount() const { return shards_.size(); }
+
+private:
+    // Each shard gets its own cache lines so neighbouring locks do not
+    // false-share.
+    struct alignas(64) Shard
+    {
+        Shard(const HashTableOptions &options) : table(DefaultShardSize, options) {}
+
+        mutable std::shared_mutex mutex;
+        HashTable table;
+    };
+
+    Shard &ShardFor(const std::string_view key) const;
+
+    static const size_t DefaultShardCount = 64;
+    static const size_t DefaultShardSize = 53;
+
+    HashTable::Hasher hash_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+#endif
@@ -0,0 +1,205 @@
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "epoch.hpp"
+
+namespace
+{
+struct Record
+{
+    // 0 while the owning thread is outside any Guard.
+    std::atomic<uint64_t> epoch{0};
+    std::atomic<bool> inUse{true};
+    Record *next = nullptr;
+    uint32_t depth = 0;
+};
+
+struct Retired
+{
+    void *object;
+    void (*deleter)(void *);
+    uint64_t epoch;
+};
+
+// Records are never freed; a thread that exits hands its record back for
+// the next thread to reuse.
+struct RecordHolder
+{
+    ~RecordHolder()
+    {
+        if (record != nullptr)
+        {
+            record->inUse.store(false, std::memory_order_release);
+        }
+    }
+
+    Record *record = nullptr;
+};
+
+const size_t CollectThreshold = 64;
+
+std::atomic<uint64_t> GlobalEpoch{1};
+std::atomic<Record *> Records{nullptr};
+std::mutex RetireMutex;
+std::vector<Retired> RetireList;
+thread_local RecordHolder LocalRecord;
+
+Record *AcquireRecord()
+{
+    for (Record *record = Records.load(std::memory_order_acquire); record != nullptr; record = record->next)
+    {
+        bool expected = false;
+        if (!record->inUse.load(std::memory_order_relaxed) &&
+            record->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+        {
+            return record;
+        }
+    }
+
+    Record *record = new Record();
+    record->next = Records.load(std::memory_order_relaxed);
+    while (!Records.compare_exchange_weak(record->next, record, std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+
+    return record;
+}
+
+Record &LocalThreadRecord()
+{
+    if (LocalRecord.record == nullptr)
+    {
+        LocalRecord.record = AcquireRecord();
+    }
+
+    return *LocalRecord.record;
+}
+
+// Requires RetireMutex.
+bool TryAdvance()
+{
+    const uint64_t epoch = GlobalEpoch.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    for (Record *record = Records.load(std::memory_order_acquire); record != nullptr; record = record->next)
+    {
+        const uint64_t pinned = record->epoch.load(std::memory_order_acquire);
+        if (pinned != 0 && pinned != epoch)
+        {
+            return false;
+        }
+    }
+
+    GlobalEpoch.store(epoch + 1, std::memory_order_release);
+    return true;
+}
+
+// Requires RetireMutex.
+void FreeReclaimable()
+{
+    const uint64_t epoch = GlobalEpoch.load(std::memory_order_acquire);
+
+    size_t kept = 0;
+    for (Retired &retired : RetireList)
+    {
+        if (retired.epoch + 2 <= epoch)
+        {
+            retired.deleter(retired.object);
+        }
+        else
+        {
+            RetireList[kept++] = retired;
+        }
+    }
+
+    RetireList.resize(kept);
+}
+
+// Requires RetireMutex.
+bool AnyPinned()
+{
+    for (Record *record = Records.load(std::memory_order_acquire); record != nullptr; record = record->next)
+    {
+        if (record->epoch.load(std::memory_order_acquire) != 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Frees whatever is still retired when the process exits, so nothing is
+// reported as leaked. Skipped if a thread that outlived main is still inside
+// a Guard, since it may yet read those objects.
+struct ExitCollector
+{
+    ~ExitCollector()
+    {
+        std::lock_guard lock(RetireMutex);
+        if (AnyPinned())
+        {
+            return;
+        }
+
+        for (Retired &retired : RetireList)
+        {
+            retired.deleter(retired.object);
+        }
+        RetireList.clear();
+    }
+};
+
+// Declared after RetireList so it is destroyed first.
+ExitCollector Collector;
+} // namespace
+
+Epoch::Guard::Guard()
+{
+    Record &record = LocalThreadRecord();
+    if (record.depth++ == 0)
+    {
+        record.epoch.store(GlobalEpoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        // Publishes the pin before any shared pointer is read.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+Epoch::Guard::~Guard()
+{
+    Record &record = *LocalRecord.record;
+    if (--record.depth == 0)
+    {
+        record.epoch.store(0, std::memory_order_release);
+    }
+}
+
+void Epoch::Retire(void *object, void (*deleter)(void *))
+{
+    // Orders the caller's unlinking store before the epoch it is stamped with.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    std::lock_guard lock(RetireMutex);
+    RetireList.push_back({object, deleter, GlobalEpoch.load(std::memory_order_relaxed)});
+
+    if (RetireList.size() % CollectThreshold == 0)
+    {
+        TryAdvance();
+        FreeReclaimable();
+    }
+}
+
+void Epoch::Collect()
+{
+    // An object is freed two epochs after it was retired, so with no reader
+    // pinned a single call reclaims everything retired so far.
+    std::lock_guard lock(RetireMutex);
+    if (TryAdvance())
+    {
+        TryAdvance();
+    }
+    FreeReclaimable();
+}
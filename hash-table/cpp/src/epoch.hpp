@@ -0,0 +1,41 @@
+#ifndef EPOCH_HPP_
+#define EPOCH_HPP_
+
+#include <cstdint>
+
+// Process-wide epoch-based reclamation. Readers pin the current epoch with a
+// Guard while they hold pointers into a shared structure; writers Retire
+// objects they have unlinked, and an object is only freed once the global
+// epoch has advanced twice past the epoch it was retired in, which can only
+// happen after every reader that could still see it has left its Guard.
+class Epoch
+{
+public:
+    // Pins the calling thread. Entering and leaving are a few plain atomic
+    // stores and never wait on other threads. Guards may nest.
+    class Guard
+    {
+    public:
+        Guard();
+        ~Guard();
+        Guard(const Guard &) = delete;
+        Guard &operator=(const Guard &) = delete;
+    };
+
+    template <typename T>
+    static void Retire(const T *object)
+    {
+        Retire(const_cast<T *>(object), [](void *p) { delete static_cast<T *>(p); });
+    }
+
+    static void Retire(void *object, void (*deleter)(void *));
+
+    // Advances the epoch (up to twice) as far as every pinned thread has
+    // caught up, then frees whatever has become unreachable. Retire calls it
+    // periodically; call it after retiring something large, such as a slot
+    // array, to free it without waiting for further retires. Anything still
+    // retired at exit is freed then, as long as no thread holds a Guard.
+    static void Collect();
+};
+
+#endif
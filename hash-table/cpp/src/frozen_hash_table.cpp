@@ -0,0 +1,272 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+#include "frozen_hash_table.hpp"
+#include "hash.hpp"
+
+namespace
+{
+// Maps x to [0, range) by the high half of x * range, which is uniform if
+// x is and needs no division.
+inline uint64_t FastRange(const uint64_t x, const uint64_t range)
+{
+#if defined(__SIZEOF_INT128__)
+    return static_cast<uint64_t>((static_cast<unsigned __int128>(x) * range) >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return __umulh(x, range);
+#else
+    const uint64_t xh = x >> 32, xl = static_cast<uint32_t>(x), rh = range >> 32, rl = static_cast<uint32_t>(range);
+    const uint64_t cross = (xl * rl >> 32) + static_cast<uint32_t>(xh * rl) + xl * rh;
+    return xh * rh + (xh * rl >> 32) + (cross >> 32);
+#endif
+}
+
+// splitmix64 finalizer; spreads a pilot-perturbed hash over all 64 bits.
+inline uint64_t Mix(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+void AppendVarint(std::vector<char> &blob, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        blob.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    blob.push_back(static_cast<char>(value));
+}
+
+inline uint64_t ReadVarint(const char *&p)
+{
+    uint64_t value{};
+    for (uint32_t shift = 0;; shift += 7)
+    {
+        const uint8_t byte = static_cast<uint8_t>(*p++);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (byte < 0x80)
+        {
+            return value;
+        }
+    }
+}
+} // namespace
+
+FrozenHashTable::FrozenHashTable(const HashTable &table)
+{
+    std::vector<std::pair<std::string_view, std::string_view>> entries;
+    entries.reserve(table.GetStats().count);
+    table.ForEach([&](const std::pmr::string &key, const std::pmr::string &value) {
+        entries.emplace_back(key, value);
+    });
+
+    const size_t count = entries.size();
+    if (count >= UINT32_MAX)
+    {
+        throw std::length_error("FrozenHashTable holds fewer than 2^32 keys");
+    }
+
+    bucketCount_ = std::max<uint64_t>(1, (count + Lambda - 1) / Lambda);
+    tableSize_ = count + count / 64 + 1;
+
+    std::vector<uint64_t> hashes(count);
+    for (salt_ = 0;; ++salt_)
+    {
+        if (salt_ == MaxSalts)
+        {
+            throw std::runtime_error("FrozenHashTable: no perfect hash found for these keys");
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            hashes[i] = WyHash(entries[i].first, salt_);
+        }
+
+        if (FindPilots(hashes))
+        {
+            break;
+        }
+    }
+
+    size_t bytes{};
+    for (const auto &[key, value] : entries)
+    {
+        bytes += key.size() + value.size() + 4;
+    }
+    blob_.reserve(bytes);
+
+    offsets_.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint64_t position = Position(hashes[i], pilots_[Bucket(hashes[i])]);
+        if (position >= count)
+        {
+            position = remap_[position - count];
+        }
+
+        offsets_[position] = blob_.size();
+        AppendVarint(blob_, entries[i].first.size());
+        AppendVarint(blob_, entries[i].second.size());
+        blob_.insert(blob_.end(), entries[i].first.begin(), entries[i].first.end());
+        blob_.insert(blob_.end(), entries[i].second.begin(), entries[i].second.end());
+    }
+}
+
+// Places buckets largest first, while positions are still easy to find,
+// trying pilots in order until every key of the bucket lands on a distinct free position.
+// Fails if some bucket exhausts all 16-bit pilots, which in practice only
+// happens when two keys share a full 64-bit hash.
+bool FrozenHashTable::FindPilots(const std::vector<uint64_t> &hashes)
+{
+    const size_t count = hashes.size();
+
+    // Keys grouped by bucket with a counting sort.
+    std::vector<uint32_t> bucketStart(bucketCount_ + 1);
+    for (const uint64_t hash : hashes)
+    {
+        ++bucketStart[Bucket(hash) + 1];
+    }
+    for (uint64_t b = 0; b < bucketCount_; ++b)
+    {
+        bucketStart[b + 1] += bucketStart[b];
+    }
+
+    std::vector<uint64_t> bucketHashes(count);
+    std::vector<uint32_t> fill(bucketStart.begin(), bucketStart.end() - 1);
+    for (const uint64_t hash : hashes)
+    {
+        bucketHashes[fill[Bucket(hash)]++] = hash;
+    }
+
+    std::vector<uint32_t> order(bucketCount_);
+    for (uint32_t b = 0; b < bucketCount_; ++b)
+    {
+        order[b] = b;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](const uint32_t a, const uint32_t b) {
+        return bucketStart[a + 1] - bucketStart[a] > bucketStart[b + 1] - bucketStart[b];
+    });
+
+    pilots_.assign(bucketCount_, 0);
+    std::vector<bool> taken(tableSize_);
+    std::vector<uint64_t> positions;
+    for (const uint32_t bucket : order)
+    {
+        const std::span<const uint64_t> keys(bucketHashes.data() + bucketStart[bucket], bucketStart[bucket + 1] - bucketStart[bucket]);
+        if (keys.empty())
+        {
+            break;
+        }
+
+        bool placed = false;
+        for (uint32_t pilot = 0; pilot <= UINT16_MAX && !placed; ++pilot)
+        {
+            positions.clear();
+            placed = true;
+            for (const uint64_t hash : keys)
+            {
+                const uint64_t position = Position(hash, static_cast<uint16_t>(pilot));
+                if (taken[position] || std::find(positions.begin(), positions.end(), position) != positions.end())
+                {
+                    placed = false;
+                    break;
+                }
+                positions.push_back(position);
+            }
+
+            if (placed)
+            {
+                pilots_[bucket] = static_cast<uint16_t>(pilot);
+                for (const uint64_t position : positions)
+                {
+                    taken[position] = true;
+                }
+            }
+        }
+
+        if (!placed)
+        {
+            return false;
+        }
+    }
+
+    // Every key placed past count takes over one of the free positions
+    // below it; there are exactly as many of each.
+    remap_.assign(tableSize_ - count, 0);
+    uint64_t free = 0;
+    for (uint64_t position = count; position < tableSize_; ++position)
+    {
+        if (taken[position])
+        {
+            while (taken[free])
+            {
+                ++free;
+            }
+            remap_[position - count] = static_cast<uint32_t>(free++);
+        }
+    }
+
+    return true;
+}
+
+uint64_t FrozenHashTable::Bucket(const uint64_t hash) const
+{
+    return FastRange(hash, bucketCount_);
+}
+
+uint64_t FrozenHashTable::Position(const uint64_t hash, const uint16_t pilot) const
+{
+    return FastRange(Mix(hash ^ (pilot * 0x9e3779b97f4a7c15ull)), tableSize_);
+}
+
+std::optional<std::string_view> FrozenHashTable::Search(const std::string_view key) const
+{
+    const size_t count = offsets_.size();
+    if (count == 0)
+    {
+        return std::nullopt;
+    }
+
+    const uint64_t hash = WyHash(key, salt_);
+    uint64_t position = Position(hash, pilots_[Bucket(hash)]);
+    if (position >= count)
+    {
+        position = remap_[position - count];
+    }
+
+    // Keys that are not in the table land on some entry too, so the key
+    // still has to be compared.
+    const char *p = blob_.data() + offsets_[position];
+    const uint64_t keyLength = ReadVarint(p);
+    const uint64_t valueLength = ReadVarint(p);
+    if (keyLength != key.size() || std::memcmp(p, key.data(), key.size()) != 0)
+    {
+        return std::nullopt;
+    }
+
+    return std::string_view(p + keyLength, valueLength);
+}
+
+size_t FrozenHashTable::GetMemoryUsage() const
+{
+    return pilots_.capacity() * sizeof(uint16_t) + remap_.capacity() * sizeof(uint32_t) +
+           offsets_.capacity() * sizeof(uint64_t) + blob_.capacity();
+}
@@ -0,0 +1,56 @@
+#ifndef FROZEN_HASH_TABLE_HPP_
+#define FROZEN_HASH_TABLE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "hash_table.hpp"
+
+// Immutable table indexed by a minimal perfect hash of its keys, built the
+// PTHash way: keys are split into buckets of about Lambda keys, and each
+// bucket gets a 16-bit pilot that sends all of its keys to free positions.
+// A lookup hashes the key once and lands on exactly one entry, which is then
+// compared against the key.
+//
+// Entries are packed into one contiguous blob as
+// [varint key length][varint value length][key][value], and the index holds
+// only a blob offset per key plus the pilots, so the whole table takes a few
+// bytes per key on top of the key and value bytes themselves.
+class FrozenHashTable
+{
+public:
+    explicit FrozenHashTable(const HashTable &table);
+
+    // The returned view points into the blob and lives as long as this.
+    std::optional<std::string_view> Search(const std::string_view key) const;
+    size_t GetCount() const { return offsets_.size(); }
+    // Bytes held by the index and the blob.
+    size_t GetMemoryUsage() const;
+
+private:
+    bool FindPilots(const std::vector<uint64_t> &hashes);
+    uint64_t Bucket(const uint64_t hash) const;
+    uint64_t Position(const uint64_t hash, const uint16_t pilot) const;
+
+    static constexpr size_t Lambda = 5;
+    // Builds that find no pilot for some bucket retry with the next salt.
+    static constexpr uint64_t MaxSalts = 64;
+
+    uint64_t salt_;
+    uint64_t bucketCount_;
+    // Positions range over tableSize_ >= count slightly more slots than
+    // there are keys, which keeps the last buckets easy to place.
+    uint64_t tableSize_;
+    std::vector<uint16_t> pilots_;
+    // Keys placed at position count + i really live at remap_[i], one of
+    // the positions below count that the pilots left free.
+    std::vector<uint32_t> remap_;
+    std::vector<uint64_t> offsets_;
+    std::vector<char> blob_;
+};
+
+#endif
@@ -0,0 +1,129 @@
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+#include "hash.hpp"
+
+namespace
+{
+constexpr uint64_t Secret[4] = {
+    0xa0761d6478bd642full,
+    0xe7037ed1a0b428dbull,
+    0x8ebc6af09c88c6e3ull,
+    0x589965cc75374cc3ull,
+};
+
+inline void Multiply(uint64_t &a, uint64_t &b)
+{
+#if defined(__SIZEOF_INT128__)
+    const unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+    a = static_cast<uint64_t>(r);
+    b = static_cast<uint64_t>(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    a = _umul128(a, b, &b);
+#else
+    const uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<uint32_t>(a), lb = static_cast<uint32_t>(b);
+    const uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    const uint64_t t = rl + (rm0 << 32);
+    uint64_t c = t < rl;
+    const uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    a = lo;
+    b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+inline uint64_t Mix(uint64_t a, uint64_t b)
+{
+    Multiply(a, b);
+    return a ^ b;
+}
+
+inline uint64_t Read8(const uint8_t *p)
+{
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t Read4(const uint8_t *p)
+{
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t Read3(const uint8_t *p, size_t k)
+{
+    return (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[k >> 1]) << 8) | p[k - 1];
+}
+} // namespace
+
+uint64_t WyHash(std::string_view key)
+{
+    return WyHash(key, 0);
+}
+
+uint64_t WyHash(std::string_view key, const uint64_t salt)
+{
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(key.data());
+    const size_t length = key.length();
+    uint64_t seed = Mix(Secret[0] ^ salt, Secret[1]);
+    uint64_t a;
+    uint64_t b;
+
+    if (length <= 16)
+    {
+        if (length >= 4)
+        {
+            a = (Read4(p) << 32) | Read4(p + ((length >> 3) << 2));
+            b = (Read4(p + length - 4) << 32) | Read4(p + length - 4 - ((length >> 3) << 2));
+        }
+        else if (length > 0)
+        {
+            a = Read3(p, length);
+            b = 0;
+        }
+        else
+        {
+            a = b = 0;
+        }
+    }
+    else
+    {
+        size_t i = length;
+        if (i > 48)
+        {
+            uint64_t see1 = seed;
+            uint64_t see2 = seed;
+            do
+            {
+                seed = Mix(Read8(p) ^ Secret[1], Read8(p + 8) ^ seed);
+                see1 = Mix(Read8(p + 16) ^ Secret[2], Read8(p + 24) ^ see1);
+                see2 = Mix(Read8(p + 32) ^ Secret[3], Read8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+
+        while (i > 16)
+        {
+            seed = Mix(Read8(p) ^ Secret[1], Read8(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+
+        a = Read8(p + i - 16);
+        b = Read8(p + i - 8);
+    }
+
+    a ^= Secret[1];
+    b ^= seed;
+    Multiply(a, b);
+    return Mix(a ^ Secret[0] ^ length, b ^ Secret[1]);
+}
@@ -0,0 +1,15 @@
+#ifndef HASH_HPP_
+#define HASH_HPP_
+
+#include <cstdint>
+#include <string_view>
+
+using HashFunction = uint64_t (*)(std::string_view key);
+
+// wyhash-style 64-bit string hash. Consumes 16 bytes per step (48 on long
+// inputs) and finishes with a 64x64->128 multiply fold.
+uint64_t WyHash(std::string_view key);
+// Each salt gives an independent hash function; salt 0 is WyHash(key).
+uint64_t WyHash(std::string_view key, const uint64_t salt);
+
+#endif
@@ -1,43 +1,1245 @@
-#ifndef HASH_TABLE_H_
-#define HASH_TABLE_H_
+#ifndef HASH_TABLE_HPP_
+#define HASH_TABLE_HPP_
 
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
 #include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <span>
+#include <stdexcept>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+#include <intrin.h>
+#endif
+
+#include "arena.hpp"
+#include "hash.hpp"
+#include "hash_table_snapshot.hpp"
+#include "hash_table_stats.hpp"
 #include "prime.hpp"
 
-struct HashTableItem
+enum class SlotState : uint8_t
+{
+    Empty,
+    Occupied,
+    Deleted,
+};
+
+// Keys and values allocate through the owning table's allocator.
+template <typename Key, typename Value>
+struct BasicHashTableEntry
+{
+    Key key;
+    Value value;
+};
+
+using HashTableEntry = BasicHashTableEntry<std::pmr::string, std::pmr::string>;
+
+// Slots are trivially constructible, so a zero-filled allocation is already a
+// valid array of empty slots. The entry only exists while the slot is occupied.
+// CacheHash keeps the full hash next to the entry for keys that are costly to
+// hash again or to compare.
+template <typename EntryType, bool CacheHash>
+struct BasicHashTableSlot
+{
+    uint64_t hash;
+    SlotState state;
+    alignas(EntryType) unsigned char storage[sizeof(EntryType)];
+
+    EntryType &Entry() { return *std::launder(reinterpret_cast<EntryType *>(storage)); }
+    const EntryType &Entry() const { return *std::launder(reinterpret_cast<const EntryType *>(storage)); }
+};
+
+template <typename EntryType>
+struct BasicHashTableSlot<EntryType, false>
+{
+    SlotState state;
+    alignas(EntryType) unsigned char storage[sizeof(EntryType)];
+
+    EntryType &Entry() { return *std::launder(reinterpret_cast<EntryType *>(storage)); }
+    const EntryType &Entry() const { return *std::launder(reinterpret_cast<const EntryType *>(storage)); }
+};
+
+// Hash policies map a key to 64 bits. Strings go through WyHash and accept
+// anything convertible to std::string_view.
+template <typename Key>
+struct DefaultHash;
+
+template <typename Alloc>
+struct DefaultHash<std::basic_string<char, std::char_traits<char>, Alloc>>
+{
+    using is_transparent = void;
+
+    uint64_t operator()(const std::string_view key) const { return WyHash(key); }
+};
+
+template <>
+struct DefaultHash<std::string_view>
+{
+    using is_transparent = void;
+
+    uint64_t operator()(const std::string_view key) const { return WyHash(key); }
+};
+
+// Integers go through MurmurHash3's 64-bit finalizer, so every input bit
+// reaches the low bits the probe indexes with. A single multiply folded
+// once does not: for keys that are multiples of 2^48 its low 16 bits were
+// all zero, and in a table below 64K slots all of them shared one home.
+template <typename Key>
+    requires std::is_integral_v<Key> || std::is_enum_v<Key>
+struct DefaultHash<Key>
+{
+    uint64_t operator()(const Key key) const
+    {
+        uint64_t hash = static_cast<uint64_t>(key);
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdull;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ull;
+        hash ^= hash >> 33;
+        return hash;
+    }
+};
+
+// Parameter type for keys passed to lookups: string keys are looked up by
+// std::string_view without building a string, trivially copyable keys are
+// passed by value.
+template <typename Key>
+struct HashTableKeyView
+{
+    using Type = std::conditional_t<std::is_trivially_copyable_v<Key>, Key, const Key &>;
+};
+
+template <typename Alloc>
+struct HashTableKeyView<std::basic_string<char, std::char_traits<char>, Alloc>>
+{
+    using Type = std::string_view;
+};
+
+// Types whose destructor only hands memory back to their allocator, so
+// entries made of them can be dropped together with the arena.
+template <typename T>
+inline constexpr bool ReleasedWithArena = std::is_trivially_destructible_v<T>;
+
+template <>
+inline constexpr bool ReleasedWithArena<std::pmr::string> = true;
+
+enum class ResizeMode : uint8_t
+{
+    // Resize moves every entry into the new slot array at once.
+    Blocking,
+    // Resize keeps the old slot array around and each Insert/Search/Delete
+    // migrates a bounded number of its slots, like Redis' dict rehashing.
+    Incremental,
+};
+
+enum class CapacityPolicy : uint8_t
 {
-    std::string key;
-    std::string value;
+    // Power-of-two sizes, indexed with a mask and probed triangularly.
+    PowerOfTwo,
+    // Prime sizes from nextPrime, probed by double hashing.
+    Prime,
+};
+
+struct HashTableOptions
+{
+    ResizeMode resizeMode = ResizeMode::Blocking;
+    CapacityPolicy capacityPolicy = CapacityPolicy::PowerOfTwo;
+    // Allocate keys and values from a table-owned ArenaResource instead of
+    // the given allocator. Destroying the table then releases whole chunks
+    // without visiting the entries. Only honoured for allocators that can be
+    // built from a std::pmr::memory_resource.
+    bool useArena = false;
+    // The table grows once entries and tombstones fill more than
+    // maxLoadFactor of the slots, and shrinks once entries fill less than
+    // minLoadFactor. minLoadFactor must stay below half of maxLoadFactor, so
+    // that neither a grow nor a shrink lands the table on the other
+    // threshold.
+    double maxLoadFactor = 0.7;
+    double minLoadFactor = 0.2;
+};
+
+// Hints that the cache line holding address will be read soon.
+inline void Prefetch(const void *address)
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_prefetch(static_cast<const char *>(address), _MM_HINT_T0);
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+    __prefetch(address);
+#else
+    __builtin_prefetch(address);
+#endif
+}
+
+// Slot indices visited for one hash. Neither policy divides past the
+// first index: prime sizes step with a conditional subtract and
+// power-of-two sizes wrap with a mask.
+class HashTableProbe
+{
+public:
+    HashTableProbe(const uint64_t hash, const size_t size, const CapacityPolicy policy)
+    {
+        size_ = size;
+        policy_ = policy;
+
+        if (policy == CapacityPolicy::PowerOfTwo)
+        {
+            // Triangular steps (1, 2, 3, ...) visit every slot of a power-of-two
+            // table exactly once.
+            index_ = hash & (size - 1);
+            step_ = 0;
+        }
+        else
+        {
+            // Double hashing: the low half picks the home slot, the high half the
+            // step. size is prime, so any non-zero step visits every slot.
+            index_ = hash % size;
+            step_ = 1 + (hash >> 32) % (size - 1);
+        }
+    }
+
+    size_t Index() const { return index_; }
+    void Next()
+    {
+        if (policy_ == CapacityPolicy::PowerOfTwo)
+        {
+            index_ = (index_ + ++step_) & (size_ - 1);
+        }
+        else
+        {
+            index_ += step_;
+            if (index_ >= size_)
+            {
+                index_ -= size_;
+            }
+        }
+    }
+
+private:
+    size_t index_;
+    size_t step_;
+    size_t size_;
+    CapacityPolicy policy_;
 };
 
-class HashTable
+// Open-addressing table with entries stored inline in the slots. Hash and
+// KeyEqual must both accept KeyView; keys and values are built with
+// uses-allocator construction from Allocator.
+//
+// Trivially copyable keys are specialized at compile time: their slots do not
+// cache the hash, and probes compare keys with KeyEqual directly.
+//
+// Pointers and references returned by the lookup and insert functions stay
+// valid until the next non-const call, which may resize or migrate entries.
+template <typename K, typename V, typename Hash = DefaultHash<K>, typename KeyEqual = std::equal_to<>, typename Allocator = std::pmr::polymorphic_allocator<std::byte>>
+class BasicHashTable
 {
 public:
-    HashTable() : HashTable(DefaultSize) {}
-    HashTable(const size_t size);
-    ~HashTable();
+    using Key = K;
+    using Value = V;
+    using KeyView = typename HashTableKeyView<K>::Type;
+    using Hasher = Hash;
+    class ConstIterator;
+
+    BasicHashTable() : BasicHashTable(DefaultSize) {}
+    BasicHashTable(const size_t size, const HashTableOptions &options = {}, const Allocator &allocator = {});
+    BasicHashTable(const BasicHashTable &) = delete;
+    BasicHashTable &operator=(const BasicHashTable &) = delete;
+    ~BasicHashTable();
 
-    void Insert(const std::string_view key, const std::string_view value);
-    const std::string_view Search(const std::string_view key);
-    void Delete(const std::string_view key);
+    template <typename T>
+    void Insert(const KeyView key, T &&value) { InsertOrAssign(key, std::forward<T>(value)); }
+    // Constructs the value from args only if the key is absent. Returns the
+    // stored value and whether it was inserted.
+    template <typename... Args>
+    std::pair<Value *, bool> TryEmplace(const KeyView key, Args &&...args);
+    // Inserts the value or assigns it over the existing one, moving from
+    // rvalues.
+    template <typename T>
+    std::pair<Value *, bool> InsertOrAssign(const KeyView key, T &&value);
+    // Returns the value for key, inserting an empty one first if needed.
+    Value &FindOrInsert(const KeyView key) { return *TryEmplace(key).first; }
+    // Calls fn on the stored value in place. Returns false if key is absent.
+    template <typename Fn>
+    bool Update(const KeyView key, Fn &&fn);
+    // Returns nullptr if key is absent.
+    Value *Search(const KeyView key);
+    // Same lookup without advancing an incremental migration, so it is safe
+    // to call from several readers at once.
+    const Value *Search(const KeyView key) const;
+    void Delete(const KeyView key);
+    // Batched forms of Search/Insert/Delete. Keys are hashed and their home
+    // slots prefetched BatchSize keys ahead of the probes, so the cache
+    // misses of different keys overlap. results and values must be at least
+    // as long as keys.
+    void SearchBatch(const std::span<const KeyView> keys, const std::span<Value *> results);
+    void SearchBatch(const std::span<const KeyView> keys, const std::span<const Value *> results) const;
+    template <typename T>
+    void InsertBatch(const std::span<const KeyView> keys, const std::span<T> values);
+    void DeleteBatch(const std::span<const KeyView> keys);
+    // Makes room for count entries in total, so that inserting up to that
+    // many does not resize again. Deletes do not shrink the table below it
+    // either.
+    void Reserve(const size_t count);
+    // Rebuilds the table at the smallest capacity that holds the current
+    // entries below the maximum load, dropping every tombstone and any
+    // reservation.
+    void ShrinkToFit();
+    // Calls fn(key, value) for every entry, in no particular order. fn must
+    // not modify the table.
+    template <typename Fn>
+    void ForEach(Fn &&fn) const;
+    // Same as ForEach, with the slot arrays split into one contiguous range
+    // per thread; threads = 0 uses every hardware thread. fn is called
+    // concurrently and must be safe to call that way. The first exception
+    // it throws is rethrown once every thread has finished.
+    template <typename Fn>
+    void ParallelForEach(Fn &&fn, size_t threads = 0) const;
+    ConstIterator begin() const;
+    ConstIterator end() const;
+    HashTableStats GetStats() const;
+    // Writes every entry to path in the format MappedHashTable serves. Only
+    // for tables whose keys and values convert to std::string_view.
+    void SaveSnapshot(const std::filesystem::path &path) const
+        requires std::is_convertible_v<const Key &, std::string_view> && std::is_convertible_v<const Value &, std::string_view>;
     size_t GetBaseSize() { return baseSize_; }
     size_t GetSize() { return size_; }
+    bool IsRehashing() const { return oldSlots_ != nullptr; }
 
 private:
+    static constexpr bool CachesHash = !std::is_trivially_copyable_v<Key>;
+
+    using Entry = BasicHashTableEntry<Key, Value>;
+    using Slot = BasicHashTableSlot<Entry, CachesHash>;
+
+    uint64_t HashOf(const KeyView key) const { return static_cast<uint64_t>(hash_(key)); }
+    template <typename... Args>
+    std::pair<Value *, bool> EmplaceHashed(const KeyView key, const uint64_t hash, Args &&...args);
+    const Value *SearchHashed(const KeyView key, const uint64_t hash) const;
+    void DeleteHashed(const KeyView key, const uint64_t hash);
+    template <typename Fn>
+    void ForEachHashed(const std::span<const KeyView> keys, Fn &&fn) const;
+    void PrefetchHome(const uint64_t hash) const;
+    uint64_t SlotHash(const Slot &slot) const;
+    bool Matches(const Slot &slot, const KeyView key, const uint64_t hash) const;
+    std::pair<Slot *, bool> FindForInsert(const KeyView key, const uint64_t hash);
     void Resize(const size_t size);
-    int32_t Hash(std::string_view key, int32_t prime, int32_t mod);
-    int32_t DoubleHash(std::string_view key, int32_t numBuckets, int32_t attempt);
+    void Rehash(const size_t size);
+    void RehashStep();
+    size_t SizeFor(const size_t count) const;
+    size_t FindEmptySlot(const uint64_t hash) const;
+    Slot *FindSlot(Slot *slots, const size_t size, const KeyView key, const uint64_t hash, size_t &probes) const;
+    size_t Capacity(const size_t size) const;
+    void MoveSlot(Slot &from, Slot &to) const;
+    void FreeSlots(Slot *slots, const size_t size);
+    static Slot *AllocateSlots(const size_t size);
+    static std::unique_ptr<ArenaResource> MakeArena(const HashTableOptions &options);
+    static Allocator MakeAllocator(std::pmr::memory_resource *resource, const Allocator &allocator);
+    void RecordProbes(const ProbeKind kind, const size_t probes) const;
+    void RecordOperation();
+#ifdef HASH_TABLE_STATS
+    static std::unique_ptr<CountingResource> MakeCountingResource(ArenaResource *arena, const Allocator &allocator);
+#endif
 
-    static const size_t DefaultSize = 53;
+    static constexpr size_t DefaultSize = 53;
+    static constexpr size_t RehashStepSize = 16;
+    static constexpr size_t BatchSize = 16;
+    static constexpr size_t MaxTombstonePercent = 25;
+    // ParallelForEach gives no thread fewer slots than this.
+    static constexpr size_t MinParallelSlots = 1 << 14;
 
+    // Declared before the slots so it outlives every entry allocated from it.
+    std::unique_ptr<ArenaResource> arena_;
+#ifdef HASH_TABLE_STATS
+    // Sits between allocator_ and the arena or the caller's resource.
+    std::unique_ptr<CountingResource> counting_;
+#endif
+    Allocator allocator_;
+    Hash hash_;
+    KeyEqual equal_;
+    ResizeMode resizeMode_;
+    CapacityPolicy capacityPolicy_;
+    double maxLoadFactor_;
+    double minLoadFactor_;
+    // Entry counts at which the current capacity grows and shrinks,
+    // recomputed whenever it changes.
+    size_t growAt_;
+    size_t shrinkAt_;
+    size_t resizes_;
+    size_t compactions_;
     size_t baseSize_;
+    // Base size set by Reserve, which shrinking never goes below.
+    size_t reservedSize_;
     size_t size_;
     size_t count_;
-    std::vector<HashTableItem *> items_;
+    // Deleted slots in slots_. Tombstones left in the array being migrated
+    // away from are not counted, since that array is dropped anyway.
+    size_t tombstones_;
+    Slot *slots_;
+    Slot *oldSlots_;
+    size_t oldSize_;
+    size_t rehashIndex_;
+#ifdef HASH_TABLE_STATS
+    // Only the instrumentation fields are kept up to date here. Probes are
+    // recorded by const lookups too, hence mutable.
+    mutable HashTableStats stats_;
+#endif
+};
+
+// Forward iterator over the entries, in no particular order, including the
+// ones an incremental resize has not moved yet. Entries are read-only through
+// it; values are changed with Update or Search. Any non-const call on the
+// table invalidates it.
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+class BasicHashTable<K, V, Hash, KeyEqual, Allocator>::ConstIterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = BasicHashTableEntry<K, V>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type *;
+    using reference = const value_type &;
+
+    ConstIterator() = default;
+
+    reference operator*() const { return slot_->Entry(); }
+    pointer operator->() const { return &slot_->Entry(); }
+    ConstIterator &operator++()
+    {
+        ++slot_;
+        SkipFree();
+        return *this;
+    }
+    ConstIterator operator++(int)
+    {
+        ConstIterator old = *this;
+        ++*this;
+        return old;
+    }
+    bool operator==(const ConstIterator &other) const { return slot_ == other.slot_; }
+
+private:
+    friend class BasicHashTable;
+
+    ConstIterator(const Slot *slot, const Slot *end, const Slot *next, const Slot *nextEnd)
+        : slot_(slot), end_(end), next_(next), nextEnd_(nextEnd)
+    {
+        SkipFree();
+    }
+
+    // Moves to the next occupied slot, going on to the old array at the end
+    // of the current one.
+    void SkipFree()
+    {
+        while (true)
+        {
+            while (slot_ != end_ && slot_->state != SlotState::Occupied)
+            {
+                ++slot_;
+            }
+
+            if (slot_ != end_ || next_ == nullptr)
+            {
+                return;
+            }
+
+            slot_ = next_;
+            end_ = nextEnd_;
+            next_ = nullptr;
+        }
+    }
+
+    const Slot *slot_{};
+    const Slot *end_{};
+    const Slot *next_{};
+    const Slot *nextEnd_{};
 };
 
-#endif
\ No newline at end of file
+using HashTable = BasicHashTable<std::pmr::string, std::pmr::string>;
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+BasicHashTable<K, V, Hash, KeyEqual, Allocator>::BasicHashTable(const size_t size, const HashTableOptions &options, const Allocator &allocator)
+#ifdef HASH_TABLE_STATS
+    : arena_(MakeArena(options)),
+      counting_(MakeCountingResource(arena_.get(), allocator)),
+      allocator_(MakeAllocator(counting_ ? static_cast<std::pmr::memory_resource *>(counting_.get()) : arena_.get(), allocator))
+#else
+    : arena_(MakeArena(options)), allocator_(MakeAllocator(arena_.get(), allocator))
+#endif
+{
+    if (!(options.maxLoadFactor > 0.0 && options.maxLoadFactor < 1.0) ||
+        !(options.minLoadFactor >= 0.0 && options.minLoadFactor < options.maxLoadFactor / 2))
+    {
+        throw std::invalid_argument("HashTableOptions: need 0 < maxLoadFactor < 1 and 0 <= minLoadFactor < maxLoadFactor / 2");
+    }
+
+    resizeMode_ = options.resizeMode;
+    capacityPolicy_ = options.capacityPolicy;
+    maxLoadFactor_ = options.maxLoadFactor;
+    minLoadFactor_ = options.minLoadFactor;
+    resizes_ = 0;
+    compactions_ = 0;
+    baseSize_ = size;
+    reservedSize_ = 0;
+    size_ = Capacity(size);
+    growAt_ = static_cast<size_t>(static_cast<double>(size_) * maxLoadFactor_);
+    shrinkAt_ = static_cast<size_t>(static_cast<double>(size_) * minLoadFactor_);
+    count_ = 0;
+    tombstones_ = 0;
+    slots_ = AllocateSlots(size_);
+    oldSlots_ = nullptr;
+    oldSize_ = 0;
+    rehashIndex_ = 0;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+BasicHashTable<K, V, Hash, KeyEqual, Allocator>::~BasicHashTable()
+{
+    FreeSlots(slots_, size_);
+    FreeSlots(oldSlots_, oldSize_);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+template <typename... Args>
+auto BasicHashTable<K, V, Hash, KeyEqual, Allocator>::TryEmplace(const KeyView key, Args &&...args) -> std::pair<Value *, bool>
+{
+    return EmplaceHashed(key, HashOf(key), std::forward<Args>(args)...);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+template <typename... Args>
+auto BasicHashTable<K, V, Hash, KeyEqual, Allocator>::EmplaceHashed(const KeyView key, const uint64_t hash, Args &&...args) -> std::pair<Value *, bool>
+{
+    const auto [slot, found] = FindForInsert(key, hash);
+    if (found)
+    {
+        return {&slot->Entry().value, false};
+    }
+
+    // The slot is only marked occupied once both key and value are built, so
+    // a throwing constructor leaves the table unchanged.
+    Entry *entry = new (slot->storage) Entry{
+        std::make_obj_using_allocator<Key>(allocator_, key),
+        std::make_obj_using_allocator<Value>(allocator_, std::forward<Args>(args)...)};
+    if constexpr (CachesHash)
+    {
+        slot->hash = hash;
+    }
+    if (slot->state == SlotState::Deleted)
+    {
+        --tombstones_;
+    }
+    slot->state = SlotState::Occupied;
+    ++count_;
+    return {&entry->value, true};
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+template <typename T>
+auto BasicHashTable<K, V, Hash, KeyEqual, Allocator>::InsertOrAssign(const KeyView key, T &&value) -> std::pair<Value *, bool>
+{
+    // TryEmplace only consumes value when it inserts, so it is still intact
+    // for the assignment otherwise.
+    const std::pair<Value *, bool> result = TryEmplace(key, std::forward<T>(value));
+    if (!result.second)
+    {
+        *result.first = std::forward<T>(value);
+    }
+
+    return result;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+template <typename Fn>
+bool BasicHashTable<K, V, Hash, KeyEqual, Allocator>::Update(const KeyView key, Fn &&fn)
+{
+    Value *value = Search(key);
+    if (value == nullptr)
+    {
+        return false;
+    }
+
+    std::forward<Fn>(fn)(*value);
+    return true;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+auto BasicHashTable<K, V, Hash, KeyEqual, Allocator>::Search(const KeyView key) -> Value *
+{
+    RehashStep();
+    RecordOperation();
+
+    return const_cast<Value *>(std::as_const(*this).Search(key));
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+auto BasicHashTable<K, V, Hash, KeyEqual, Allocator>::Search(const KeyView key) const -> const Value *
+{
+    return SearchHashed(key, HashOf(key));
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+auto BasicHashTable<K, V, Hash, KeyEqual, Allocator>::SearchHashed(const KeyView key, const uint64_t hash) const -> const Value *
+{
+    size_t probes{};
+    const Slot *slot = FindSlot(slots_, size_, key, hash, probes);
+    if (slot == nullptr)
+    {
+        slot = FindSlot(oldSlots_, oldSize_, key, hash, probes);
+    }
+
+    RecordProbes(slot != nullptr ? ProbeKind::SearchHit : ProbeKind::SearchMiss, probes);
+    return slot != nullptr ? &slot->Entry().value : nullptr;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<K, V, Hash, KeyEqual, Allocator>::Delete(const KeyView key)
+{
+    DeleteHashed(key, HashOf(key));
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<K, V, Hash, KeyEqual, Allocator>::DeleteHashed(const KeyView key, const uint64_t hash)
+{
+    RehashStep();
+    RecordOperation();
+
+    size_t probes{};
+    Slot *slot = FindSlot(slots_, size_, key, hash, probes);
+    if (slot != nullptr)
+    {
+        ++tombstones_;
+    }
+    else
+    {
+        slot = FindSlot(oldSlots_, oldSize_, key, hash, probes);
+    }
+
+    RecordProbes(slot != nullptr ? ProbeKind::DeleteHit : ProbeKind::DeleteMiss, probes);
+    if (slot == nullptr)
+    {
+        return;
+    }
+
+    // Release the payload now; the slot itself stays behind as a tombstone.
+    std::destroy_at(&slot->Entry());
+    slot->state = SlotState::Deleted;
+    --count_;
+
+    // Checked after the removal, against the entries that are actually left.
+    // A reserved table stays at its reserved size however empty it gets.
+    if (count_ < shrinkAt_ && size_ / 2 >= reservedSize_)
+    {
+        Resize(size_ / 2);
+    }
+    // Searches step over every tombstone on their path, so once too many
+    // pile up the table is rebuilt at the same size without them. This waits
+    // for a running migration, which would otherwise have to finish at once.
+    else if (!IsRehashing() && tombstones_ * 100 / size_ > MaxTombstonePercent)
+    {
+        Rehash(size_);
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<K, V, Hash, KeyEqual, Allocator>::SearchBatch(const std::span<const KeyView> keys, const std::span<Value *> results)
+{
+    RehashStep();
+
+    ForEachHashed(keys, [&](const size_t i, const uint64_t hash) {
+        RecordOperation();
+        results[i] = const_cast<Value *>(SearchHashed(keys[i], hash));
+    });
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<K, V, Hash, KeyEqual, Allocator>::SearchBatch(const std::span<const KeyView> keys, const std::span<const Value *> results) const
+{
+    ForEachHashed(keys, [&](const size_t i, const uint64_t hash) {
+        results[i] = SearchHashed(keys[i], hash);
+    });
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+template <typename T>
+void BasicHashTable<K, V, Hash, KeyEqual, Allocator>::InsertBatch(const std::span<const KeyView> keys, const std::span<T> values)
+{
+    ForEachHashed(keys, [&](const size_t i, const uint64_t hash) {
+        const std::pair<Value *, bool> result = EmplaceHashed(keys[i], hash, values[i]);
+        if (!result.second)
+        {
+            *result.first = values[i];
+        }
+    });
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<K, V, Hash, KeyEqual, Allocator>::DeleteBatch(const std::span<const KeyView> keys)
+{
+    ForEachHashed(keys, [&](const size_t i, const uint64_t hash) {
+        DeleteHashed(keys[i], hash);
+    });
+}
+
+// Calls fn(index, hash) for every key in order, keeping the home slots of
+// the next BatchSize keys in flight. A resize partway through only makes the
+// outstanding prefetches useless, since the hashes themselves do not depend
+// on the table size.
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+template <typename Fn>
+void BasicHashTable<K, V, Hash, KeyEqual, Allocator>::ForEachHashed(const std::span<const KeyView> keys, Fn &&fn) const
+{
+    static_assert(std::has_single_bit(BatchSize));
+
+    uint64_t hashes[BatchSize];
+    const size_t ahead = std::min(BatchSize, keys.size());
+    for (size_t i = 0; i < ahead; ++i)
+    {
+        hashes[i] = HashOf(keys[i]);
+        PrefetchHome(hashes[i]);
+    }
+
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        const uint64_t hash = hashes[i & (BatchSize - 1)];
+        if (i + BatchSize < keys.size())
+        {
+            hashes[i & (BatchSize - 1)] = HashOf(keys[i + BatchSize]);
+            PrefetchHome(hashes[i & (BatchSize - 1)]);
+        }
+
+        fn(i, hash);
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<K, V, Hash, KeyEqual, Allocator>::PrefetchHome(const uint64_t hash) const
+{
+    Prefetch(&slots_[HashTableProbe(hash, size_, capacityPolicy_).Index()]);
+    if (IsRehashing())
+    {
+        Prefetch(&oldSlots_[HashTableProbe(hash, oldSize_, capacityPolicy_).Index()]);
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+uint64_t BasicHashTable<K, V, Hash, KeyEqual, Allocator>::SlotHash(const Slot &slot) const
+{
+    if constexpr (CachesHash)
+    {
+        return slot.hash;
+    }
+    else
+    {
+        return HashOf(slot.Entry().key);
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+bool BasicHashTable<K, V, Hash, KeyEqual, Allocator>::Matches(const Slot &slot, const KeyView key, const uint64_t hash) const
+{
+    if constexpr (CachesHash)
+    {
+        return slot.hash == hash && equal_(slot.Entry().key, key);
+    }
+    else
+    {
+        return equal_(slot.Entry().key, key);
+    }
+}
+
+// Returns the slot holding key and true, or the slot a new entry for it
+// belongs in and false: the first tombstone on its probe path, otherwise
+// the empty slot that ended it. Any resize happens here, before the slot is
+// picked.
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+auto BasicHashTable<K, V, Hash, KeyEqual, Allocator>::FindForInsert(const KeyView key, const uint64_t hash) -> std::pair<Slot *, bool>
+{
+    // Tombstones lengthen probes just like entries do, so they count towards
+    // the load. When they make up enough of it, the table is rebuilt at the
+    // same size instead of grown. The cut-off sits halfway between twice the
+    // shrink threshold and the grow threshold, so a grown table starts above
+    // the former and a compacted one below the latter.
+    if (count_ + tombstones_ >= growAt_)
+    {
+        Rehash(count_ * 2 >= growAt_ + 2 * shrinkAt_ ? size_ * 2 : size_);
+    }
+
+    RehashStep();
+    RecordOperation();
+
+    HashTableProbe probe(hash, size_, capacityPolicy_);
+    Slot *slot = &slots_[probe.Index()];
+    Slot *tombstone = nullptr;
+    size_t probes = 1;
+
+    while (slot->state != SlotState::Empty)
+    {
+        if (slot->state == SlotState::Occupied && Matches(*slot, key, hash))
+        {
+            RecordProbes(ProbeKind::InsertHit, probes);
+            return {slot, true};
+        }
+
+        if (slot->state == SlotState::Deleted && tombstone == nullptr)
+        {
+            tombstone = slot;
+        }
+
+        probe.Next();
+        slot = &slots_[probe.Index()];
+        ++probes;
+    }
+
+    // Keys that have not been migrated yet are updated where they are.
+    if (Slot *old = FindSlot(oldSlots_, oldSize_, key, hash, probes))
+    {
+        RecordProbes(ProbeKind::InsertHit, probes);
+        return {old, true};
+    }
+
+    RecordProbes(ProbeKind::InsertMiss, probes);
+    return {tombstone != nullptr ? tombstone : slot, false};
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<K, V, Hash, KeyEqual, Allocator>::Resize(const size_t size)
+{
+    if (size < DefaultSize)
+    {
+        return;
+    }
+
+    Rehash(size);
+}
+
+// Moves every entry into a fresh slot array for base size `size`, which may
+// equal the current one to just drop tombstones.
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<K, V, Hash, KeyEqual, Allocator>::Rehash(const size_t size)
+{
+    // Only one migration runs at a time; a resize requested while one is in
+    // flight finishes it first.
+    while (IsRehashing())
+    {
+        RehashStep();
+    }
+
+#ifdef HASH_TABLE_STATS
+    const auto start = std::chrono::steady_clock::now();
+#endif
+
+    Slot *slots = slots_;
+    const size_t oldSize = size_;
+    baseSize_ = size;
+    size_ = Capacity(size);
+    slots_ = AllocateSlots(size_);
+    tombstones_ = 0;
+    growAt_ = static_cast<size_t>(static_cast<double>(size_) * maxLoadFactor_);
+    shrinkAt_ = static_cast<size_t>(static_cast<double>(size_) * minLoadFactor_);
+    ++(size_ != oldSize ? resizes_ : compactions_);
+
+    if (resizeMode_ == ResizeMode::Incremental)
+    {
+        oldSlots_ = slots;
+        oldSize_ = oldSize;
+        rehashIndex_ = 0;
+    }
+    else
+    {
+        // Entries are placed by their hash and moved, so no key is copied
+        // again and tombstones are dropped along the way.
+        for (size_t i = 0; i < oldSize; ++i)
+        {
+            if (slots[i].state == SlotState::Occupied)
+            {
+                MoveSlot(slots[i], slots_[FindEmptySlot(SlotHash(slots[i]))]);
+            }
+        }
+
+        std::free(slots);
+    }
+
+#ifdef HASH_TABLE_STATS
+    const auto end = std::chrono::steady_clock::now();
+    AddResizeSample(stats_, {stats_.operations, oldSize, size_, static_cast<uint64_t>(std::chrono::nanoseconds(end - start).count())});
+#endif
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<K, V, Hash, KeyEqual, Allocator>::Reserve(const size_t count)
+{
+    const size_t size = SizeFor(count);
+    reservedSize_ = std::max(reservedSize_, size);
+    if (Capacity(size) > size_)
+    {
+        Rehash(size);
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<K, V, Hash, KeyEqual, Allocator>::ShrinkToFit()
+{
+    const size_t size = std::max(SizeFor(count_), DefaultSize);
+    reservedSize_ = 0;
+    if (Capacity(size) < size_ || tombstones_ != 0 || IsRehashing())
+    {
+        Rehash(size);
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+HashTableStats BasicHashTable<K, V, Hash, KeyEqual, Allocator>::GetStats() const
+{
+#ifdef HASH_TABLE_STATS
+    HashTableStats stats = stats_;
+    stats.slotBytes = (size_ + oldSize_) * sizeof(Slot);
+    if (counting_)
+    {
+        stats.entryBytes = counting_->GetBytes();
+        stats.peakEntryBytes = counting_->GetPeakBytes();
+        stats.entryAllocations = counting_->GetAllocations();
+    }
+#else
+    HashTableStats stats;
+#endif
+    stats.count = count_;
+    stats.tombstones = tombstones_;
+    stats.capacity = size_;
+    stats.resizes = resizes_;
+    stats.compactions = compactions_;
+    return stats;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<K, V, Hash, KeyEqual, Allocator>::SaveSnapshot(const std::filesystem::path &path) const
+    requires std::is_convertible_v<const Key &, std::string_view> && std::is_convertible_v<const Value &, std::string_view>
+{
+    std::vector<SnapshotEntry> entries;
+    entries.reserve(count_);
+    ForEach([&](const Key &key, const Value &value) {
+        entries.push_back({key, value});
+    });
+
+    WriteSnapshot(path, entries);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+template <typename Fn>
+void BasicHashTable<K, V, Hash, KeyEqual, Allocator>::ForEach(Fn &&fn) const
+{
+    for (const Entry &entry : *this)
+    {
+        fn(entry.key, entry.value);
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+template <typename Fn>
+void BasicHashTable<K, V, Hash, KeyEqual, Allocator>::ParallelForEach(Fn &&fn, size_t threads) const
+{
+    if (threads == 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // The old array of a migration is scanned as if it followed slots_.
+    const size_t total = size_ + oldSize_;
+    threads = std::clamp<size_t>(total / MinParallelSlots, 1, threads);
+
+    const auto scan = [&](const size_t begin, const size_t end) {
+        const auto visit = [&](const Slot &slot) {
+            if (slot.state == SlotState::Occupied)
+            {
+                fn(slot.Entry().key, slot.Entry().value);
+            }
+        };
+
+        for (size_t i = begin; i < std::min(end, size_); ++i)
+        {
+            visit(slots_[i]);
+        }
+        for (size_t i = std::max(begin, size_); i < end; ++i)
+        {
+            visit(oldSlots_[i - size_]);
+        }
+    };
+
+    std::vector<std::exception_ptr> errors(threads);
+    const auto run = [&](const size_t t) {
+        try
+        {
+            scan(total * t / threads, total * (t + 1) / threads);
+        }
+        catch (...)
+        {
+            errors[t] = std::current_exception();
+        }
+    };
+
+    // Range 0 runs on the calling thread.
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (size_t t = 1; t < threads; ++t)
+    {
+        workers.emplace_back(run, t);
+    }
+    run(0);
+
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+    for (const std::exception_ptr &error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+auto BasicHashTable<K, V, Hash, KeyEqual, Allocator>::begin() const -> ConstIterator
+{
+    return ConstIterator(slots_, slots_ + size_, oldSlots_, oldSlots_ + oldSize_);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+auto BasicHashTable<K, V, Hash, KeyEqual, Allocator>::end() const -> ConstIterator
+{
+    const Slot *last = IsRehashing() ? oldSlots_ + oldSize_ : slots_ + size_;
+    return ConstIterator(last, last, nullptr, nullptr);
+}
+
+// Smallest base size whose capacity keeps count entries below the grow
+// threshold.
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+size_t BasicHashTable<K, V, Hash, KeyEqual, Allocator>::SizeFor(const size_t count) const
+{
+    return static_cast<size_t>(static_cast<double>(count) / maxLoadFactor_) + 1;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<K, V, Hash, KeyEqual, Allocator>::RehashStep()
+{
+    if (!IsRehashing())
+    {
+        return;
+    }
+
+#ifdef HASH_TABLE_STATS
+    const auto start = std::chrono::steady_clock::now();
+#endif
+
+    const size_t end = std::min(rehashIndex_ + RehashStepSize, oldSize_);
+    for (; rehashIndex_ < end; ++rehashIndex_)
+    {
+        Slot &slot = oldSlots_[rehashIndex_];
+        if (slot.state == SlotState::Occupied)
+        {
+            MoveSlot(slot, slots_[FindEmptySlot(SlotHash(slot))]);
+        }
+    }
+
+    if (rehashIndex_ == oldSize_)
+    {
+        // Every entry has been moved out, so there is nothing left to destroy.
+        std::free(oldSlots_);
+        oldSlots_ = nullptr;
+        oldSize_ = 0;
+        rehashIndex_ = 0;
+    }
+
+#ifdef HASH_TABLE_STATS
+    // Charged to the migration that Rehash started.
+    const uint64_t nanoseconds = std::chrono::nanoseconds(std::chrono::steady_clock::now() - start).count();
+    stats_.resizeSamples.back().nanoseconds += nanoseconds;
+    stats_.resizeNanoseconds += nanoseconds;
+#endif
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+size_t BasicHashTable<K, V, Hash, KeyEqual, Allocator>::FindEmptySlot(const uint64_t hash) const
+{
+    HashTableProbe probe(hash, size_, capacityPolicy_);
+    while (slots_[probe.Index()].state != SlotState::Empty)
+    {
+        probe.Next();
+    }
+
+    return probe.Index();
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+auto BasicHashTable<K, V, Hash, KeyEqual, Allocator>::FindSlot(Slot *slots, const size_t size, const KeyView key, const uint64_t hash, size_t &probes) const -> Slot *
+{
+    if (slots == nullptr)
+    {
+        return nullptr;
+    }
+
+    HashTableProbe probe(hash, size, capacityPolicy_);
+    Slot *slot = &slots[probe.Index()];
+    ++probes;
+
+    while (slot->state != SlotState::Empty)
+    {
+        if (slot->state == SlotState::Occupied && Matches(*slot, key, hash))
+        {
+            return slot;
+        }
+
+        probe.Next();
+        slot = &slots[probe.Index()];
+        ++probes;
+    }
+
+    return nullptr;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+size_t BasicHashTable<K, V, Hash, KeyEqual, Allocator>::Capacity(const size_t size) const
+{
+    if (capacityPolicy_ == CapacityPolicy::PowerOfTwo)
+    {
+        return std::bit_ceil(size);
+    }
+
+    return nextPrime(size);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<K, V, Hash, KeyEqual, Allocator>::MoveSlot(Slot &from, Slot &to) const
+{
+    new (to.storage) Entry(std::move(from.Entry()));
+    if constexpr (CachesHash)
+    {
+        to.hash = from.hash;
+    }
+    to.state = SlotState::Occupied;
+
+    // The source becomes a tombstone so probe chains through a half-migrated
+    // array still reach the entries behind it.
+    std::destroy_at(&from.Entry());
+    from.state = SlotState::Deleted;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<K, V, Hash, KeyEqual, Allocator>::FreeSlots(Slot *slots, const size_t size)
+{
+    if (slots == nullptr)
+    {
+        return;
+    }
+
+    // Entries that own nothing, or nothing but arena memory, are not
+    // destroyed one by one; the arena goes away in one piece.
+    const bool releasedWithArena = arena_ && ReleasedWithArena<Key> && ReleasedWithArena<Value>;
+    if (!std::is_trivially_destructible_v<Entry> && !releasedWithArena)
+    {
+        for (size_t i = 0; i < size; ++i)
+        {
+            if (slots[i].state == SlotState::Occupied)
+            {
+                std::destroy_at(&slots[i].Entry());
+            }
+        }
+    }
+
+    std::free(slots);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+auto BasicHashTable<K, V, Hash, KeyEqual, Allocator>::AllocateSlots(const size_t size) -> Slot *
+{
+    // calloc hands large arrays back as untouched zero pages, so a new slot
+    // array costs nothing until its slots are actually probed.
+    void *slots = std::calloc(size, sizeof(Slot));
+    if (slots == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    return static_cast<Slot *>(slots);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+std::unique_ptr<ArenaResource> BasicHashTable<K, V, Hash, KeyEqual, Allocator>::MakeArena(const HashTableOptions &options)
+{
+    if constexpr (std::is_constructible_v<Allocator, std::pmr::memory_resource *>)
+    {
+        if (options.useArena)
+        {
+            return std::make_unique<ArenaResource>();
+        }
+    }
+
+    return nullptr;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+Allocator BasicHashTable<K, V, Hash, KeyEqual, Allocator>::MakeAllocator(std::pmr::memory_resource *resource, const Allocator &allocator)
+{
+    if constexpr (std::is_constructible_v<Allocator, std::pmr::memory_resource *>)
+    {
+        if (resource != nullptr)
+        {
+            return Allocator(resource);
+        }
+    }
+
+    return allocator;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<K, V, Hash, KeyEqual, Allocator>::RecordProbes([[maybe_unused]] const ProbeKind kind, [[maybe_unused]] const size_t probes) const
+{
+#ifdef HASH_TABLE_STATS
+    stats_.probes[static_cast<size_t>(kind)].Record(probes);
+#endif
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+void BasicHashTable<K, V, Hash, KeyEqual, Allocator>::RecordOperation()
+{
+#ifdef HASH_TABLE_STATS
+    if (++stats_.operations % stats_.loadSampleInterval == 0)
+    {
+        AddLoadSample(stats_, {stats_.operations, count_, tombstones_, size_});
+    }
+#endif
+}
+
+#ifdef HASH_TABLE_STATS
+template <typename K, typename V, typename Hash, typename KeyEqual, typename Allocator>
+std::unique_ptr<CountingResource> BasicHashTable<K, V, Hash, KeyEqual, Allocator>::MakeCountingResource(ArenaResource *arena, const Allocator &allocator)
+{
+    if constexpr (std::is_constructible_v<Allocator, std::pmr::memory_resource *> && requires { { allocator.resource() } -> std::convertible_to<std::pmr::memory_resource *>; })
+    {
+        return std::make_unique<CountingResource>(arena != nullptr ? arena : allocator.resource());
+    }
+
+    return nullptr;
+}
+#endif
+
+#endif
@@ -0,0 +1,391 @@
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "hash.hpp"
+#include "hash_table_snapshot.hpp"
+
+static_assert(sizeof(SnapshotHeader) == 64);
+static_assert(sizeof(SnapshotSlot) == 24);
+
+namespace
+{
+constexpr char Magic[8] = {'H', 'T', 'S', 'N', 'A', 'P', '\0', '\0'};
+constexpr uint64_t MinSlotCount = 16;
+// The checksum is the WyHash of the WyHashes of consecutive blocks of this
+// size, so the writer can compute it while streaming the file out.
+constexpr size_t ChecksumBlockSize = 1 << 20;
+
+uint64_t CombineBlockHashes(const std::vector<uint64_t> &hashes)
+{
+    return WyHash(std::string_view(reinterpret_cast<const char *>(hashes.data()), hashes.size() * sizeof(uint64_t)));
+}
+
+// Buffers output into checksum blocks and hashes each one on its way out.
+class ChecksumWriter
+{
+public:
+    explicit ChecksumWriter(std::ofstream &file) : file_(file) { block_.reserve(ChecksumBlockSize); }
+
+    void Write(const void *data, size_t size)
+    {
+        const char *bytes = static_cast<const char *>(data);
+        while (size != 0)
+        {
+            const size_t chunk = std::min(size, ChecksumBlockSize - block_.size());
+            block_.insert(block_.end(), bytes, bytes + chunk);
+            bytes += chunk;
+            size -= chunk;
+
+            if (block_.size() == ChecksumBlockSize)
+            {
+                Flush();
+            }
+        }
+    }
+
+    uint64_t Finish()
+    {
+        if (!block_.empty())
+        {
+            Flush();
+        }
+        return CombineBlockHashes(blockHashes_);
+    }
+
+private:
+    void Flush()
+    {
+        blockHashes_.push_back(WyHash(std::string_view(block_.data(), block_.size())));
+        file_.write(block_.data(), static_cast<std::streamsize>(block_.size()));
+        block_.clear();
+    }
+
+    std::ofstream &file_;
+    std::vector<char> block_;
+    std::vector<uint64_t> blockHashes_;
+};
+
+[[noreturn]] void Fail(const std::filesystem::path &path, const std::string_view problem)
+{
+    throw std::runtime_error("snapshot " + path.string() + ": " + std::string(problem));
+}
+
+// Flushes a written file to the disk, so that renaming it into place cannot
+// leave a name pointing at data that a crash would lose.
+void SyncFile(const std::filesystem::path &path)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    const bool synced = file != INVALID_HANDLE_VALUE && FlushFileBuffers(file);
+    if (file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(file);
+    }
+#else
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    const bool synced = fd >= 0 && fsync(fd) == 0;
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+#endif
+    if (!synced)
+    {
+        Fail(path, "cannot sync to disk");
+    }
+}
+
+// Makes a rename within directory durable. NTFS journals the rename itself,
+// so there is nothing to do on Windows.
+void SyncDirectory([[maybe_unused]] const std::filesystem::path &directory)
+{
+#ifndef _WIN32
+    const std::filesystem::path name = directory.empty() ? std::filesystem::path(".") : directory;
+    const int fd = open(name.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    const bool synced = fd >= 0 && fsync(fd) == 0;
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    if (!synced)
+    {
+        Fail(name, "cannot sync to disk");
+    }
+#endif
+}
+
+void Unmap(const std::byte *base, [[maybe_unused]] const size_t size)
+{
+#ifdef _WIN32
+    UnmapViewOfFile(base);
+#else
+    munmap(const_cast<std::byte *>(base), size);
+#endif
+}
+
+// Returns what is wrong with the header, or an empty view if it describes a
+// snapshot that fits in size bytes.
+std::string_view CheckHeader(const SnapshotHeader &header, const size_t size)
+{
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0)
+    {
+        return "not a hash table snapshot";
+    }
+    if (header.byteOrder != SnapshotByteOrder)
+    {
+        return "written on a machine of the other byte order";
+    }
+    if (header.version != SnapshotVersion)
+    {
+        return "unsupported snapshot version";
+    }
+
+    const bool consistent =
+        std::has_single_bit(header.slotCount) && header.count < header.slotCount &&
+        header.slotsOffset == sizeof(SnapshotHeader) &&
+        header.slotCount <= (size - sizeof(SnapshotHeader)) / sizeof(SnapshotSlot) &&
+        header.dataOffset == header.slotsOffset + header.slotCount * sizeof(SnapshotSlot) &&
+        header.fileSize == size;
+    return consistent ? std::string_view() : "header does not match the file";
+}
+} // namespace
+
+void WriteSnapshot(const std::filesystem::path &path, const std::span<const SnapshotEntry> entries)
+{
+    // Between a third and two thirds full, which keeps linear probing short
+    // for hits and misses alike.
+    const uint64_t slotCount = std::bit_ceil(std::max<uint64_t>(MinSlotCount, entries.size() + entries.size() / 2 + 1));
+    std::vector<SnapshotSlot> slots(slotCount, SnapshotSlot{0, SnapshotEmptyOffset, 0, 0});
+    // The entry each slot was filled from, to compare keys against.
+    std::vector<const SnapshotEntry *> owners(slotCount);
+
+    uint64_t dataSize{};
+    for (const SnapshotEntry &entry : entries)
+    {
+        if (entry.key.size() > UINT32_MAX || entry.value.size() > UINT32_MAX)
+        {
+            throw std::length_error("snapshot keys and values must be shorter than 4 GiB");
+        }
+
+        const uint64_t hash = WyHash(entry.key);
+        uint64_t index = hash & (slotCount - 1);
+        while (slots[index].offset != SnapshotEmptyOffset)
+        {
+            if (slots[index].hash == hash && owners[index]->key == entry.key)
+            {
+                throw std::invalid_argument("snapshot keys must be unique");
+            }
+            index = (index + 1) & (slotCount - 1);
+        }
+
+        slots[index] = {hash, dataSize, static_cast<uint32_t>(entry.key.size()), static_cast<uint32_t>(entry.value.size())};
+        owners[index] = &entry;
+        dataSize += entry.key.size() + entry.value.size();
+    }
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = SnapshotVersion;
+    header.byteOrder = SnapshotByteOrder;
+    header.count = entries.size();
+    header.slotCount = slotCount;
+    header.slotsOffset = sizeof(SnapshotHeader);
+    header.dataOffset = header.slotsOffset + slotCount * sizeof(SnapshotSlot);
+    header.fileSize = header.dataOffset + dataSize;
+
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            Fail(temporary, "cannot open for writing");
+        }
+
+        // The header is written again at the end, once the checksum is known.
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        ChecksumWriter writer(file);
+        writer.Write(slots.data(), slots.size() * sizeof(SnapshotSlot));
+        for (const SnapshotEntry &entry : entries)
+        {
+            writer.Write(entry.key.data(), entry.key.size());
+            writer.Write(entry.value.data(), entry.value.size());
+        }
+        header.checksum = writer.Finish();
+
+        file.seekp(0);
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.close();
+        if (!file)
+        {
+            Fail(temporary, "write failed");
+        }
+    }
+
+    // The data must be on disk before the rename is, or a crash could leave
+    // an empty or partial snapshot under the final name.
+    SyncFile(temporary);
+    std::filesystem::rename(temporary, path);
+    SyncDirectory(path.parent_path());
+}
+
+MappedHashTable::MappedHashTable(const std::filesystem::path &path)
+{
+#ifdef _WIN32
+    // Lookups land on random pages, so read-ahead would only waste I/O.
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        Fail(path, "cannot open");
+    }
+
+    LARGE_INTEGER fileSize{};
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart != 0)
+    {
+        mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    CloseHandle(file);
+    if (mapping == nullptr)
+    {
+        Fail(path, "cannot map");
+    }
+
+    // The view keeps the mapping object alive on its own.
+    const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (view == nullptr)
+    {
+        Fail(path, "cannot map");
+    }
+
+    base_ = static_cast<const std::byte *>(view);
+    size_ = static_cast<size_t>(fileSize.QuadPart);
+#else
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        Fail(path, "cannot open");
+    }
+
+    struct stat status{};
+    if (fstat(fd, &status) != 0 || status.st_size == 0)
+    {
+        close(fd);
+        Fail(path, "cannot map");
+    }
+
+    // MAP_SHARED on a read-only file: every process mapping it shares the
+    // same page cache pages.
+    void *view = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED)
+    {
+        Fail(path, "cannot map");
+    }
+
+    // Lookups land on random pages, so read-ahead would only waste I/O.
+    madvise(view, static_cast<size_t>(status.st_size), MADV_RANDOM);
+
+    base_ = static_cast<const std::byte *>(view);
+    size_ = static_cast<size_t>(status.st_size);
+#endif
+
+    SnapshotHeader header{};
+    if (size_ >= sizeof(header))
+    {
+        std::memcpy(&header, base_, sizeof(header));
+    }
+
+    const std::string_view problem = size_ < sizeof(header) ? "too small for a header" : CheckHeader(header, size_);
+    if (!problem.empty())
+    {
+        Unmap(base_, size_);
+        Fail(path, problem);
+    }
+
+    slots_ = reinterpret_cast<const SnapshotSlot *>(base_ + header.slotsOffset);
+    mask_ = header.slotCount - 1;
+    data_ = reinterpret_cast<const char *>(base_ + header.dataOffset);
+    dataSize_ = header.fileSize - header.dataOffset;
+    count_ = header.count;
+    checksum_ = header.checksum;
+}
+
+MappedHashTable::~MappedHashTable()
+{
+    Unmap(base_, size_);
+}
+
+std::optional<std::string_view> MappedHashTable::Search(const std::string_view key) const
+{
+    const uint64_t hash = WyHash(key);
+
+    // Bounded by the slot count, so even a damaged file cannot loop forever.
+    uint64_t index = hash & mask_;
+    for (uint64_t probes = 0; probes <= mask_; ++probes, index = (index + 1) & mask_)
+    {
+        const SnapshotSlot &slot = slots_[index];
+        if (slot.offset == SnapshotEmptyOffset)
+        {
+            break;
+        }
+
+        if (slot.hash != hash || slot.keyLength != key.size())
+        {
+            continue;
+        }
+
+        // Likewise, offsets are checked so no lookup reads past the mapping.
+        if (slot.offset > dataSize_ || dataSize_ - slot.offset < static_cast<uint64_t>(slot.keyLength) + slot.valueLength)
+        {
+            break;
+        }
+
+        const char *entry = data_ + slot.offset;
+        if (std::memcmp(entry, key.data(), key.size()) == 0)
+        {
+            return std::string_view(entry + slot.keyLength, slot.valueLength);
+        }
+    }
+
+    return std::nullopt;
+}
+
+bool MappedHashTable::Verify() const
+{
+    const char *body = reinterpret_cast<const char *>(base_) + sizeof(SnapshotHeader);
+    const size_t bodySize = size_ - sizeof(SnapshotHeader);
+
+    std::vector<uint64_t> blockHashes;
+    for (size_t offset = 0; offset < bodySize; offset += ChecksumBlockSize)
+    {
+        blockHashes.push_back(WyHash(std::string_view(body + offset, std::min(ChecksumBlockSize, bodySize - offset))));
+    }
+
+    return CombineBlockHashes(blockHashes) == checksum_;
+}
@@ -0,0 +1,95 @@
+#ifndef HASH_TABLE_SNAPSHOT_HPP_
+#define HASH_TABLE_SNAPSHOT_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string_view>
+
+// On-disk layout, in the byte order of the machine that wrote it:
+//
+//   SnapshotHeader   64 bytes
+//   SnapshotSlot[]   slotCount slots, linearly probed by WyHash(key)
+//   data             key bytes followed by value bytes, per entry
+//
+// Slots refer to their entry by offset from the start of the data area, so
+// the image is position independent and can be served straight from a
+// read-only mapping.
+struct SnapshotHeader
+{
+    char magic[8];
+    uint32_t version;
+    // SnapshotByteOrder as written; reads back differently on a machine of
+    // the other byte order.
+    uint32_t byteOrder;
+    uint64_t count;
+    // Always a power of two.
+    uint64_t slotCount;
+    uint64_t slotsOffset;
+    uint64_t dataOffset;
+    uint64_t fileSize;
+    // Covers every byte after the header; see MappedHashTable::Verify.
+    uint64_t checksum;
+};
+
+struct SnapshotSlot
+{
+    uint64_t hash;
+    // SnapshotEmptyOffset marks a free slot.
+    uint64_t offset;
+    uint32_t keyLength;
+    uint32_t valueLength;
+};
+
+inline constexpr uint32_t SnapshotVersion = 1;
+inline constexpr uint32_t SnapshotByteOrder = 0x01020304;
+inline constexpr uint64_t SnapshotEmptyOffset = UINT64_MAX;
+
+struct SnapshotEntry
+{
+    std::string_view key;
+    std::string_view value;
+};
+
+// Writes entries to path in the layout above. The file is written next to
+// path, synced and renamed over it at the end, and the directory is synced
+// after, so readers never see a partial snapshot, even after a crash.
+// Throws std::runtime_error on I/O failure, std::invalid_argument if two
+// entries share a key and std::length_error for keys or values of 4 GiB or
+// more.
+void WriteSnapshot(const std::filesystem::path &path, const std::span<const SnapshotEntry> entries);
+
+// Read-only table served from a memory-mapped snapshot. Opening only checks
+// the header, so it costs the same for any size; pages are faulted in as
+// lookups touch them and are shared with every other process mapping the
+// same file.
+class MappedHashTable
+{
+public:
+    // Throws std::runtime_error if the file cannot be mapped or its header
+    // does not describe a snapshot this version can read.
+    explicit MappedHashTable(const std::filesystem::path &path);
+    MappedHashTable(const MappedHashTable &) = delete;
+    MappedHashTable &operator=(const MappedHashTable &) = delete;
+    ~MappedHashTable();
+
+    // The returned view points into the mapping and lives as long as this.
+    std::optional<std::string_view> Search(const std::string_view key) const;
+    // Recomputes the checksum over the whole file, reading every page.
+    bool Verify() const;
+    size_t GetCount() const { return count_; }
+
+private:
+    const std::byte *base_;
+    size_t size_;
+    const SnapshotSlot *slots_;
+    uint64_t mask_;
+    const char *data_;
+    uint64_t dataSize_;
+    size_t count_;
+    uint64_t checksum_;
+};
+
+#endif
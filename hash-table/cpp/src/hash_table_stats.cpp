@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "hash_table_stats.hpp"
+
+void ProbeHistogram::Record(const size_t probes)
+{
+    const size_t bucket = std::min(probes, BucketCount) - 1;
+    std::atomic_ref<uint64_t>(buckets[bucket]).fetch_add(1, std::memory_order_relaxed);
+    std::atomic_ref<uint64_t>(totalProbes).fetch_add(probes, std::memory_order_relaxed);
+
+    std::atomic_ref<uint64_t> max(maxProbes);
+    uint64_t current = max.load(std::memory_order_relaxed);
+    while (current < probes && !max.compare_exchange_weak(current, probes, std::memory_order_relaxed))
+    {
+    }
+}
+
+uint64_t ProbeHistogram::GetCount() const
+{
+    uint64_t count{};
+    for (const uint64_t bucket : buckets)
+    {
+        count += bucket;
+    }
+    return count;
+}
+
+double ProbeHistogram::GetMean() const
+{
+    const uint64_t count = GetCount();
+    return count == 0 ? 0.0 : static_cast<double>(totalProbes) / static_cast<double>(count);
+}
+
+static double LoadFactor(const size_t count, const size_t capacity)
+{
+    return capacity == 0 ? 0.0 : static_cast<double>(count) / static_cast<double>(capacity);
+}
+
+static void AppendField(std::string &json, const std::string_view name, const std::string &value)
+{
+    if (json.back() != '{')
+    {
+        json += ',';
+    }
+    json += '"';
+    json += name;
+    json += "\":";
+    json += value;
+}
+
+static void AppendField(std::string &json, const std::string_view name, const uint64_t value)
+{
+    AppendField(json, name, std::to_string(value));
+}
+
+static void AppendField(std::string &json, const std::string_view name, const double value)
+{
+    AppendField(json, name, std::to_string(value));
+}
+
+#ifdef HASH_TABLE_STATS
+static std::string ToJson(const ProbeHistogram &histogram)
+{
+    std::string json = "{";
+    AppendField(json, "count", histogram.GetCount());
+    AppendField(json, "mean", histogram.GetMean());
+    AppendField(json, "max", histogram.maxProbes);
+
+    // Bucket i holds probes of length i + 1.
+    std::string buckets = "[";
+    for (size_t i = 0; i < ProbeHistogram::BucketCount; ++i)
+    {
+        buckets += i == 0 ? "" : ",";
+        buckets += std::to_string(histogram.buckets[i]);
+    }
+    buckets += ']';
+    AppendField(json, "buckets", buckets);
+
+    json += '}';
+    return json;
+}
+#endif
+
+std::string ToJson(const HashTableStats &stats)
+{
+    std::string json = "{";
+    AppendField(json, "count", stats.count);
+    AppendField(json, "tombstones", stats.tombstones);
+    AppendField(json, "capacity", stats.capacity);
+    AppendField(json, "loadFactor", LoadFactor(stats.count, stats.capacity));
+    AppendField(json, "resizes", stats.resizes);
+    AppendField(json, "compactions", stats.compactions);
+
+#ifdef HASH_TABLE_STATS
+    static constexpr std::string_view ProbeKindNames[ProbeKindCount] = {
+        "searchHit", "searchMiss", "insertHit", "insertMiss", "deleteHit", "deleteMiss"};
+
+    AppendField(json, "operations", stats.operations);
+
+    std::string probes = "{";
+    for (size_t i = 0; i < ProbeKindCount; ++i)
+    {
+        AppendField(probes, ProbeKindNames[i], ToJson(stats.probes[i]));
+    }
+    probes += '}';
+    AppendField(json, "probes", probes);
+
+    AppendField(json, "loadSampleInterval", stats.loadSampleInterval);
+    std::string samples = "[";
+    for (const LoadSample &sample : stats.loadSamples)
+    {
+        std::string entry = "{";
+        AppendField(entry, "operation", sample.operation);
+        AppendField(entry, "count", sample.count);
+        AppendField(entry, "tombstones", sample.tombstones);
+        AppendField(entry, "loadFactor", LoadFactor(sample.count + sample.tombstones, sample.capacity));
+        samples += samples.size() == 1 ? "" : ",";
+        samples += entry + '}';
+    }
+    samples += ']';
+    AppendField(json, "loadSamples", samples);
+
+    AppendField(json, "resizeNanoseconds", stats.resizeNanoseconds);
+    std::string resizes = "[";
+    for (const ResizeSample &sample : stats.resizeSamples)
+    {
+        std::string entry = "{";
+        AppendField(entry, "operation", sample.operation);
+        AppendField(entry, "fromCapacity", sample.fromCapacity);
+        AppendField(entry, "toCapacity", sample.toCapacity);
+        AppendField(entry, "nanoseconds", sample.nanoseconds);
+        resizes += resizes.size() == 1 ? "" : ",";
+        resizes += entry + '}';
+    }
+    resizes += ']';
+    AppendField(json, "resizeSamples", resizes);
+
+    AppendField(json, "slotBytes", stats.slotBytes);
+    AppendField(json, "entryBytes", stats.entryBytes);
+    AppendField(json, "peakEntryBytes", stats.peakEntryBytes);
+    AppendField(json, "entryAllocations", stats.entryAllocations);
+#endif
+
+    json += '}';
+    return json;
+}
+
+#ifdef HASH_TABLE_STATS
+void AddLoadSample(HashTableStats &stats, const LoadSample &sample)
+{
+    if (stats.loadSamples.size() == HashTableStats::MaxSamples)
+    {
+        // Thin out to every other sample so the whole history stays covered
+        // at half the resolution.
+        for (size_t i = 0; i < HashTableStats::MaxSamples / 2; ++i)
+        {
+            stats.loadSamples[i] = stats.loadSamples[2 * i + 1];
+        }
+        stats.loadSamples.resize(HashTableStats::MaxSamples / 2);
+        stats.loadSampleInterval *= 2;
+    }
+
+    stats.loadSamples.push_back(sample);
+}
+
+void AddResizeSample(HashTableStats &stats, const ResizeSample &sample)
+{
+    if (stats.resizeSamples.size() == HashTableStats::MaxSamples)
+    {
+        stats.resizeSamples.erase(stats.resizeSamples.begin(), stats.resizeSamples.begin() + HashTableStats::MaxSamples / 2);
+    }
+
+    stats.resizeSamples.push_back(sample);
+    stats.resizeNanoseconds += sample.nanoseconds;
+}
+
+void *CountingResource::do_allocate(const size_t bytes, const size_t alignment)
+{
+    void *p = upstream_->allocate(bytes, alignment);
+    bytes_ += bytes;
+    peakBytes_ = std::max(peakBytes_, bytes_);
+    ++allocations_;
+    return p;
+}
+
+void CountingResource::do_deallocate(void *p, const size_t bytes, const size_t alignment)
+{
+    upstream_->deallocate(p, bytes, alignment);
+    bytes_ -= bytes;
+}
+#endif
@@ -0,0 +1,125 @@
+#ifndef HASH_TABLE_STATS_HPP_
+#define HASH_TABLE_STATS_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+// Defining HASH_TABLE_STATS turns on the instrumentation below: probe-length
+// histograms, load samples, resize timings and allocated bytes. It changes
+// the layout of BasicHashTable and HashTableStats, so it must be defined the
+// same way for every translation unit of a build. Without it only the plain
+// counters at the top of HashTableStats are kept.
+
+enum class ProbeKind : uint8_t
+{
+    SearchHit,
+    SearchMiss,
+    // Insert of a key that was already present.
+    InsertHit,
+    InsertMiss,
+    DeleteHit,
+    DeleteMiss,
+};
+
+inline constexpr size_t ProbeKindCount = 6;
+
+// Operations bucketed by the number of slots they visited, including the
+// empty slot that ends a miss. The last bucket also takes every longer probe.
+struct ProbeHistogram
+{
+    static constexpr size_t BucketCount = 32;
+
+    // Uses relaxed atomic updates, so concurrent readers of a const table
+    // can all record into the same histogram.
+    void Record(const size_t probes);
+    uint64_t GetCount() const;
+    double GetMean() const;
+
+    std::array<uint64_t, BucketCount> buckets{};
+    uint64_t totalProbes{};
+    uint64_t maxProbes{};
+};
+
+struct LoadSample
+{
+    uint64_t operation;
+    size_t count;
+    size_t tombstones;
+    size_t capacity;
+};
+
+// One rebuild of the slot array. fromCapacity == toCapacity for a compaction.
+// Incremental migrations add the time of every step until they finish.
+struct ResizeSample
+{
+    uint64_t operation;
+    size_t fromCapacity;
+    size_t toCapacity;
+    uint64_t nanoseconds;
+};
+
+struct HashTableStats
+{
+    size_t count{};
+    size_t tombstones{};
+    size_t capacity{};
+    // Rebuilds of the slot array that changed its capacity, and ones that
+    // kept it to drop tombstones.
+    size_t resizes{};
+    size_t compactions{};
+#ifdef HASH_TABLE_STATS
+    static constexpr size_t MaxSamples = 1024;
+
+    // Inserts, Deletes and non-const Searches, batched ones included.
+    uint64_t operations{};
+    std::array<ProbeHistogram, ProbeKindCount> probes{};
+    // Taken every loadSampleInterval operations. When MaxSamples are held,
+    // every other one is dropped and the interval doubles.
+    std::vector<LoadSample> loadSamples;
+    uint64_t loadSampleInterval = 1024;
+    // The most recent rebuilds; resizeNanoseconds covers all of them.
+    std::vector<ResizeSample> resizeSamples;
+    uint64_t resizeNanoseconds{};
+    size_t slotBytes{};
+    // Bytes of keys and values currently allocated through the table's
+    // allocator. Only tracked for std::pmr allocators.
+    size_t entryBytes{};
+    size_t peakEntryBytes{};
+    uint64_t entryAllocations{};
+#endif
+};
+
+// Serializes stats as a single JSON object.
+std::string ToJson(const HashTableStats &stats);
+
+#ifdef HASH_TABLE_STATS
+void AddLoadSample(HashTableStats &stats, const LoadSample &sample);
+void AddResizeSample(HashTableStats &stats, const ResizeSample &sample);
+
+// Forwards to upstream and counts the bytes that pass through.
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    explicit CountingResource(std::pmr::memory_resource *upstream) : upstream_(upstream) {}
+
+    size_t GetBytes() const { return bytes_; }
+    size_t GetPeakBytes() const { return peakBytes_; }
+    uint64_t GetAllocations() const { return allocations_; }
+
+private:
+    void *do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+    std::pmr::memory_resource *upstream_;
+    size_t bytes_{};
+    size_t peakBytes_{};
+    uint64_t allocations_{};
+};
+#endif
+
+#endif
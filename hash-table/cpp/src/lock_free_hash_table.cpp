@@ -0,0 +1,203 @@
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "epoch.hpp"
+#include "hash_table.hpp"
+#include "lock_free_hash_table.hpp"
+
+namespace
+{
+// Marks a deleted slot, so probe chains through it stay intact.
+const LockFreeEntry DeletedEntry{};
+} // namespace
+
+LockFreeHashTable::SlotArray::SlotArray(const size_t size)
+    : size(size), slots(new std::atomic<const LockFreeEntry *>[size]())
+{
+}
+
+LockFreeHashTable::LockFreeHashTable(const size_t size, const HashFunction hash)
+{
+    hash_ = hash;
+    slots_.store(new SlotArray(std::bit_ceil(size)), std::memory_order_relaxed);
+    count_ = 0;
+    tombstones_ = 0;
+}
+
+LockFreeHashTable::~LockFreeHashTable()
+{
+    SlotArray *array = slots_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < array->size; ++i)
+    {
+        const LockFreeEntry *entry = array->slots[i].load(std::memory_order_relaxed);
+        if (entry != nullptr && entry != &DeletedEntry)
+        {
+            delete entry;
+        }
+    }
+
+    delete array;
+
+    // Frees the arrays and entries this table retired, unless a reader that
+    // raced its destruction is still pinned.
+    Epoch::Collect();
+}
+
+void LockFreeHashTable::Insert(const std::string_view key, const std::string_view value)
+{
+    std::lock_guard lock(writeMutex_);
+
+    // Tombstones are only cleared by a rebuild, so they count towards the load.
+    SlotArray *array = slots_.load(std::memory_order_relaxed);
+    if ((count_ + tombstones_ + 1) * 100 / array->size > 70)
+    {
+        Resize(std::bit_ceil((count_ + 1) * 2));
+        array = slots_.load(std::memory_order_relaxed);
+    }
+
+    const uint64_t hash = hash_(key);
+    std::atomic<const LockFreeEntry *> *insertAt = nullptr;
+    std::atomic<const LockFreeEntry *> *slot = FindSlot(*array, key, hash, insertAt);
+
+    const LockFreeEntry *entry = new LockFreeEntry{hash, std::string(key), std::string(value)};
+    if (slot != nullptr)
+    {
+        const LockFreeEntry *old = slot->exchange(entry, std::memory_order_acq_rel);
+        Epoch::Retire(old);
+        return;
+    }
+
+    if (insertAt->load(std::memory_order_relaxed) == &DeletedEntry)
+    {
+        --tombstones_;
+    }
+
+    insertAt->store(entry, std::memory_order_release);
+    ++count_;
+}
+
+std::optional<std::string> LockFreeHashTable::Search(const std::string_view key) const
+{
+    const uint64_t hash = hash_(key);
+    Epoch::Guard guard;
+
+    // Bounded by the slot count: writers keep every array below 70% full and
+    // never modify an array once it has been replaced.
+    const SlotArray *array = slots_.load(std::memory_order_acquire);
+    HashTableProbe probe(hash, array->size, CapacityPolicy::PowerOfTwo);
+    while (true)
+    {
+        const LockFreeEntry *entry = array->slots[probe.Index()].load(std::memory_order_acquire);
+        if (entry == nullptr)
+        {
+            return std::nullopt;
+        }
+
+        if (entry != &DeletedEntry && entry->hash == hash && entry->key == key)
+        {
+            return entry->value;
+        }
+
+        probe.Next();
+    }
+}
+
+void LockFreeHashTable::Delete(const std::string_view key)
+{
+    std::lock_guard lock(writeMutex_);
+
+    const uint64_t hash = hash_(key);
+    std::atomic<const LockFreeEntry *> *insertAt = nullptr;
+    std::atomic<const LockFreeEntry *> *slot = FindSlot(*slots_.load(std::memory_order_relaxed), key, hash, insertAt);
+    if (slot == nullptr)
+    {
+        return;
+    }
+
+    const LockFreeEntry *old = slot->exchange(&DeletedEntry, std::memory_order_acq_rel);
+    Epoch::Retire(old);
+    --count_;
+    ++tombstones_;
+}
+
+size_t LockFreeHashTable::GetSize() const
+{
+    // A concurrent Insert may replace and retire the array being read.
+    Epoch::Guard guard;
+    return slots_.load(std::memory_order_acquire)->size;
+}
+
+std::atomic<const LockFreeEntry *> *LockFreeHashTable::FindSlot(const SlotArray &array, const std::string_view key, const uint64_t hash, std::atomic<const LockFreeEntry *> *&insertAt) const
+{
+    // Writer side only: returns the slot holding key, or nullptr with insertAt
+    // set to the first reusable slot on the probe path.
+    insertAt = nullptr;
+
+    HashTableProbe probe(hash, array.size, CapacityPolicy::PowerOfTwo);
+    while (true)
+    {
+        std::atomic<const LockFreeEntry *> &slot = array.slots[probe.Index()];
+        const LockFreeEntry *entry = slot.load(std::memory_order_relaxed);
+        if (entry == nullptr)
+        {
+            if (insertAt == nullptr)
+            {
+                insertAt = &slot;
+            }
+            return nullptr;
+        }
+
+        if (entry == &DeletedEntry)
+        {
+            if (insertAt == nullptr)
+            {
+                insertAt = &slot;
+            }
+        }
+        else if (entry->hash == hash && entry->key == key)
+        {
+            return &slot;
+        }
+
+        probe.Next();
+    }
+}
+
+void LockFreeHashTable::Resize(const size_t size)
+{
+    SlotArray *old = slots_.load(std::memory_order_relaxed);
+    SlotArray *array = new SlotArray(size < DefaultSize ? DefaultSize : size);
+
+    // Entries are immutable, so the new array shares them with the old one
+    // and only the pointers move. Tombstones are left behind.
+    for (size_t i = 0; i < old->size; ++i)
+    {
+        const LockFreeEntry *entry = old->slots[i].load(std::memory_order_relaxed);
+        if (entry == nullptr || entry == &DeletedEntry)
+        {
+            continue;
+        }
+
+        HashTableProbe probe(entry->hash, array->size, CapacityPolicy::PowerOfTwo);
+        while (array->slots[probe.Index()].load(std::memory_order_relaxed) != nullptr)
+        {
+            probe.Next();
+        }
+        array->slots[probe.Index()].store(entry, std::memory_order_relaxed);
+    }
+
+    slots_.store(array, std::memory_order_release);
+    tombstones_ = 0;
+    Epoch::Retire(old);
+
+    // The old array is as large as the whole table, so it is freed as soon
+    // as the readers still probing it leave, rather than after further
+    // retires that never come once writes stop.
+    Epoch::Collect();
+}
@@ -0,0 +1,61 @@
+#ifndef LOCK_FREE_HASH_TABLE_HPP_
+#define LOCK_FREE_HASH_TABLE_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "hash.hpp"
+
+struct LockFreeEntry
+{
+    uint64_t hash;
+    std::string key;
+    std::string value;
+};
+
+// Table for read-mostly workloads whose Search never takes a lock or waits on
+// a writer. Slots are atomic pointers to immutable entries: writers publish a
+// new entry (or a new slot array on resize) with a release store and hand the
+// one it replaced to Epoch::Retire, so readers inside an Epoch::Guard can keep
+// using whatever they loaded. Writers are serialized by a mutex.
+class LockFreeHashTable
+{
+public:
+    LockFreeHashTable() : LockFreeHashTable(DefaultSize) {}
+    LockFreeHashTable(const size_t size, const HashFunction hash = WyHash);
+    LockFreeHashTable(const LockFreeHashTable &) = delete;
+    LockFreeHashTable &operator=(const LockFreeHashTable &) = delete;
+    ~LockFreeHashTable();
+
+    void Insert(const std::string_view key, const std::string_view value);
+    std::optional<std::string> Search(const std::string_view key) const;
+    void Delete(const std::string_view key);
+    size_t GetSize() const;
+
+private:
+    struct SlotArray
+    {
+        explicit SlotArray(const size_t size);
+
+        size_t size;
+        std::unique_ptr<std::atomic<const LockFreeEntry *>[]> slots;
+    };
+
+    std::atomic<const LockFreeEntry *> *FindSlot(const SlotArray &array, const std::string_view key, const uint64_t hash, std::atomic<const LockFreeEntry *> *&insertAt) const;
+    void Resize(const size_t size);
+
+    static const size_t DefaultSize = 64;
+
+    HashFunction hash_;
+    std::mutex writeMutex_;
+    std::atomic<SlotArray *> slots_;
+    size_t count_;
+    size_t tombstones_;
+};
+
+#endif
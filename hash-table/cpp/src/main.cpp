@@ -88,10 +88,10 @@ int32_t main(int32_t argc, char **argv)
     size_t counter{};
     for (auto &p : pairs)
     {
-        std::string_view value = table.Search(p.first);
-        if (!value.empty())
+        const HashTable::Value *value = table.Search(p.first);
+        if (value != nullptr)
         {
-            std::println("{} pair: {} | {}", counter++, p.first, value);
+            std::println("{} pair: {} | {}", counter++, p.first, std::string_view(*value));
         }
     }
 
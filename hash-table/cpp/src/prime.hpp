@@ -1,5 +1,5 @@
-#ifndef PRIME_H_
-#define PRIME_H_
+#ifndef PRIME_HPP_
+#define PRIME_HPP_
 
 #include <cstdint>
 
@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "hash.hpp"
+#include "hash_table.hpp"
+#include "robin_hood_hash_table.hpp"
+
+namespace
+{
+// Short, even probes let the table run fuller than one that leaves
+// tombstones: at most 7/8 of the slots are in use.
+inline size_t MaxLoad(const size_t capacity)
+{
+    return capacity - capacity / 8;
+}
+} // namespace
+
+RobinHoodHashTable::RobinHoodHashTable(const size_t size, const HashFunction hash)
+{
+    hash_ = hash;
+    count_ = 0;
+    Allocate(std::bit_ceil(std::max<size_t>(size, 8)));
+}
+
+RobinHoodHashTable::~RobinHoodHashTable()
+{
+    for (size_t i = 0; i < capacity_; ++i)
+    {
+        if (slots_[i].distance != 0)
+        {
+            std::destroy_at(&slots_[i].Entry());
+        }
+    }
+
+    std::free(slots_);
+}
+
+void RobinHoodHashTable::Insert(const std::string_view key, const std::string_view value)
+{
+    const uint64_t hash = hash_(key);
+    const size_t found = Find(key, hash);
+    if (found != capacity_)
+    {
+        slots_[found].Entry().value = value;
+        return;
+    }
+
+    if (count_ + 1 > MaxLoad(capacity_))
+    {
+        Grow();
+    }
+
+    Place(HashTableEntry{std::pmr::string(key), std::pmr::string(value)}, hash);
+    ++count_;
+}
+
+const std::pmr::string *RobinHoodHashTable::Search(const std::string_view key) const
+{
+    const size_t index = Find(key, hash_(key));
+    if (index == capacity_)
+    {
+        return nullptr;
+    }
+
+    return &slots_[index].Entry().value;
+}
+
+void RobinHoodHashTable::Delete(const std::string_view key)
+{
+    size_t index = Find(key, hash_(key));
+    if (index == capacity_)
+    {
+        return;
+    }
+
+    std::destroy_at(&slots_[index].Entry());
+    --count_;
+
+    // Backward-shift deletion: every following entry that is not in its home
+    // slot moves back one, closing the gap a tombstone would have left.
+    const size_t mask = capacity_ - 1;
+    size_t next = (index + 1) & mask;
+    while (slots_[next].distance > 1)
+    {
+        RobinHoodHashTableSlot &from = slots_[next];
+        RobinHoodHashTableSlot &to = slots_[index];
+        new (to.storage) HashTableEntry(std::move(from.Entry()));
+        std::destroy_at(&from.Entry());
+        to.hash = from.hash;
+        to.distance = from.distance - 1;
+
+        index = next;
+        next = (next + 1) & mask;
+    }
+
+    slots_[index].distance = 0;
+}
+
+size_t RobinHoodHashTable::Find(const std::string_view key, const uint64_t hash) const
+{
+    const size_t mask = capacity_ - 1;
+    size_t index = hash & mask;
+
+    for (uint32_t distance = 1;; ++distance)
+    {
+        // Every entry on the path is at least as far from home as the key
+        // would be here; an empty slot or a closer one ends the search.
+        const RobinHoodHashTableSlot &slot = slots_[index];
+        if (slot.distance < distance)
+        {
+            return capacity_;
+        }
+
+        if (slot.hash == hash && slot.Entry().key.compare(key) == 0)
+        {
+            return index;
+        }
+
+        index = (index + 1) & mask;
+    }
+}
+
+// Inserts an entry whose key is known to be absent.
+void RobinHoodHashTable::Place(HashTableEntry &&entry, uint64_t hash)
+{
+    HashTableEntry carried(std::move(entry));
+    const size_t mask = capacity_ - 1;
+    size_t index = hash & mask;
+    uint32_t distance = 1;
+
+    while (true)
+    {
+        RobinHoodHashTableSlot &slot = slots_[index];
+        if (slot.distance == 0)
+        {
+            new (slot.storage) HashTableEntry(std::move(carried));
+            slot.hash = hash;
+            slot.distance = distance;
+            return;
+        }
+
+        // The resident is closer to home than the carried entry, so it gives
+        // up the slot and is carried on instead.
+        if (slot.distance < distance)
+        {
+            std::swap(carried, slot.Entry());
+            std::swap(hash, slot.hash);
+            std::swap(distance, slot.distance);
+        }
+
+        index = (index + 1) & mask;
+        ++distance;
+    }
+}
+
+void RobinHoodHashTable::Grow()
+{
+    const size_t oldCapacity = capacity_;
+    RobinHoodHashTableSlot *oldSlots = slots_;
+
+    Allocate(capacity_ * 2);
+
+    // Entries are placed by their cached hash and moved, never rehashed.
+    for (size_t i = 0; i < oldCapacity; ++i)
+    {
+        RobinHoodHashTableSlot &from = oldSlots[i];
+        if (from.distance != 0)
+        {
+            Place(std::move(from.Entry()), from.hash);
+            std::destroy_at(&from.Entry());
+        }
+    }
+
+    std::free(oldSlots);
+}
+
+void RobinHoodHashTable::Allocate(const size_t capacity)
+{
+    capacity_ = capacity;
+
+    // Zeroed slots all have distance 0, so calloc returns an empty table.
+    slots_ = static_cast<RobinHoodHashTableSlot *>(std::calloc(capacity, sizeof(RobinHoodHashTableSlot)));
+    if (slots_ == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+}
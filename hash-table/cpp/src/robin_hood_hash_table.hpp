@@ -0,0 +1,59 @@
+#ifndef ROBIN_HOOD_HASH_TABLE_HPP_
+#define ROBIN_HOOD_HASH_TABLE_HPP_
+
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <string_view>
+
+#include "hash.hpp"
+#include "hash_table.hpp"
+
+struct RobinHoodHashTableSlot
+{
+    uint64_t hash;
+    // Distance from the entry's home slot plus one; 0 marks an empty slot.
+    uint32_t distance;
+    alignas(HashTableEntry) unsigned char storage[sizeof(HashTableEntry)];
+
+    HashTableEntry &Entry() { return *std::launder(reinterpret_cast<HashTableEntry *>(storage)); }
+    const HashTableEntry &Entry() const { return *std::launder(reinterpret_cast<const HashTableEntry *>(storage)); }
+};
+
+// Linear-probing table with Robin Hood insertion: an entry that has probed
+// further from its home slot takes the place of one that has probed less,
+// which keeps probe lengths short and even. A search stops at the first slot
+// whose entry sits closer to home than the key would, and Delete shifts the
+// entries after it back one slot, so the table never holds tombstones.
+class RobinHoodHashTable
+{
+public:
+    RobinHoodHashTable() : RobinHoodHashTable(DefaultSize) {}
+    RobinHoodHashTable(const size_t size, const HashFunction hash = WyHash);
+    RobinHoodHashTable(const RobinHoodHashTable &) = delete;
+    RobinHoodHashTable &operator=(const RobinHoodHashTable &) = delete;
+    ~RobinHoodHashTable();
+
+    void Insert(const std::string_view key, const std::string_view value);
+    // Returns nullptr if key is absent.
+    const std::pmr::string *Search(const std::string_view key) const;
+    void Delete(const std::string_view key);
+    size_t GetSize() const { return capacity_; }
+    size_t GetCount() const { return count_; }
+
+private:
+    size_t Find(const std::string_view key, const uint64_t hash) const;
+    void Place(HashTableEntry &&entry, uint64_t hash);
+    void Grow();
+    void Allocate(const size_t capacity);
+
+    static const size_t DefaultSize = 64;
+
+    HashFunction hash_;
+    size_t capacity_;
+    size_t count_;
+    RobinHoodHashTableSlot *slots_;
+};
+
+#endif
@@ -0,0 +1,410 @@
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SWISS_HASH_TABLE_SSE2
+#endif
+
+#include "hash.hpp"
+#include "hash_table.hpp"
+#include "swiss_hash_table.hpp"
+
+namespace
+{
+// Full slots store the low 7 bits of their hash; the high bit marks the
+// other two states.
+constexpr int8_t Empty = -128;  // 0b10000000
+constexpr int8_t Deleted = -2;  // 0b11111110
+
+// Iterates the set bits of a match mask, lowest slot first.
+class BitMask
+{
+public:
+    explicit BitMask(uint32_t mask) : mask_(mask) {}
+
+    explicit operator bool() const { return mask_ != 0; }
+    uint32_t Lowest() const { return static_cast<uint32_t>(std::countr_zero(mask_)); }
+    uint32_t Bits() const { return mask_; }
+    void Next() { mask_ &= mask_ - 1; }
+
+private:
+    uint32_t mask_;
+};
+
+#if defined(__AVX2__)
+struct Group
+{
+    static constexpr size_t Width = 32;
+
+    explicit Group(const int8_t *control) : control(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(control))) {}
+
+    BitMask Match(const int8_t fragment) const
+    {
+        const __m256i match = _mm256_cmpeq_epi8(_mm256_set1_epi8(fragment), control);
+        return BitMask(static_cast<uint32_t>(_mm256_movemask_epi8(match)));
+    }
+
+    BitMask MatchEmpty() const
+    {
+        return Match(Empty);
+    }
+
+    BitMask MatchEmptyOrDeleted() const
+    {
+        const __m256i match = _mm256_cmpgt_epi8(_mm256_set1_epi8(-1), control);
+        return BitMask(static_cast<uint32_t>(_mm256_movemask_epi8(match)));
+    }
+
+    // Full slots are the ones whose control byte has the sign bit clear.
+    BitMask MatchFull() const
+    {
+        return BitMask(~static_cast<uint32_t>(_mm256_movemask_epi8(control)));
+    }
+
+    __m256i control;
+};
+#elif defined(SWISS_HASH_TABLE_SSE2)
+struct Group
+{
+    static constexpr size_t Width = 16;
+
+    explicit Group(const int8_t *control) : control(_mm_loadu_si128(reinterpret_cast<const __m128i *>(control))) {}
+
+    BitMask Match(const int8_t fragment) const
+    {
+        const __m128i match = _mm_cmpeq_epi8(_mm_set1_epi8(fragment), control);
+        return BitMask(static_cast<uint32_t>(_mm_movemask_epi8(match)));
+    }
+
+    BitMask MatchEmpty() const
+    {
+        return Match(Empty);
+    }
+
+    BitMask MatchEmptyOrDeleted() const
+    {
+        const __m128i match = _mm_cmpgt_epi8(_mm_set1_epi8(-1), control);
+        return BitMask(static_cast<uint32_t>(_mm_movemask_epi8(match)));
+    }
+
+    BitMask MatchFull() const
+    {
+        return BitMask(~static_cast<uint32_t>(_mm_movemask_epi8(control)) & 0xffff);
+    }
+
+    __m128i control;
+};
+#else
+struct Group
+{
+    static constexpr size_t Width = 16;
+
+    explicit Group(const int8_t *control)
+    {
+        std::memcpy(this->control, control, Width);
+    }
+
+    BitMask Match(const int8_t fragment) const
+    {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < Width; ++i)
+        {
+            mask |= static_cast<uint32_t>(control[i] == fragment) << i;
+        }
+        return BitMask(mask);
+    }
+
+    BitMask MatchEmpty() const
+    {
+        return Match(Empty);
+    }
+
+    BitMask MatchEmptyOrDeleted() const
+    {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < Width; ++i)
+        {
+            mask |= static_cast<uint32_t>(control[i] < -1) << i;
+        }
+        return BitMask(mask);
+    }
+
+    BitMask MatchFull() const
+    {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < Width; ++i)
+        {
+            mask |= static_cast<uint32_t>(control[i] >= 0) << i;
+        }
+        return BitMask(mask);
+    }
+
+    int8_t control[Width];
+};
+#endif
+
+inline uint64_t H1(const uint64_t hash)
+{
+    return hash >> 7;
+}
+
+inline int8_t H2(const uint64_t hash)
+{
+    return static_cast<int8_t>(hash & 0x7f);
+}
+
+// At most 7/8 of the slots may be full or deleted.
+inline size_t MaxLoad(const size_t capacity)
+{
+    return capacity - capacity / 8;
+}
+
+// Walks the groups in triangular order, which visits every group exactly once
+// when the group count is a power of two.
+class ProbeSequence
+{
+public:
+    ProbeSequence(const uint64_t hash, const size_t capacity)
+        : mask_(capacity / Group::Width - 1), group_(H1(hash) & mask_), step_(0)
+    {
+    }
+
+    size_t Offset() const { return group_ * Group::Width; }
+    void Next() { group_ = (group_ + ++step_) & mask_; }
+
+private:
+    size_t mask_;
+    size_t group_;
+    size_t step_;
+};
+} // namespace
+
+SwissHashTable::SwissHashTable(const size_t size, const HashFunction hash)
+{
+    hash_ = hash;
+    count_ = 0;
+    Allocate(std::bit_ceil(std::max(size, Group::Width)));
+}
+
+SwissHashTable::~SwissHashTable()
+{
+    for (size_t i = 0; i < capacity_; ++i)
+    {
+        if (control_[i] >= 0)
+        {
+            std::destroy_at(&slots_[i].Entry());
+        }
+    }
+
+    std::free(control_);
+    std::free(slots_);
+}
+
+void SwissHashTable::Insert(const std::string_view key, const std::string_view value)
+{
+    const uint64_t hash = hash_(key);
+    const size_t found = Find(key, hash);
+    if (found != capacity_)
+    {
+        slots_[found].Entry().value = value;
+        return;
+    }
+
+    size_t index = FindInsertSlot(hash);
+    if (growthLeft_ == 0 && control_[index] == Empty)
+    {
+        // Drop tombstones in place while the table is mostly tombstones,
+        // otherwise double the capacity.
+        Rehash(count_ * 2 <= MaxLoad(capacity_) ? capacity_ : capacity_ * 2);
+        index = FindInsertSlot(hash);
+    }
+
+    if (control_[index] == Empty)
+    {
+        --growthLeft_;
+    }
+
+    new (slots_[index].storage) HashTableEntry{std::pmr::string(key), std::pmr::string(value)};
+    slots_[index].hash = hash;
+    control_[index] = H2(hash);
+    ++count_;
+}
+
+const std::pmr::string *SwissHashTable::Search(const std::string_view key) const
+{
+    const size_t index = Find(key, hash_(key));
+    if (index == capacity_)
+    {
+        return nullptr;
+    }
+
+    return &slots_[index].Entry().value;
+}
+
+void SwissHashTable::Delete(const std::string_view key)
+{
+    const size_t index = Find(key, hash_(key));
+    if (index == capacity_)
+    {
+        return;
+    }
+
+    std::destroy_at(&slots_[index].Entry());
+    --count_;
+
+    // Probes stop at the first group with an empty slot. If this group
+    // already has one, no probe passes through it and the slot can go back
+    // to empty instead of becoming a tombstone.
+    const size_t groupStart = index & ~(Group::Width - 1);
+    if (Group(control_ + groupStart).MatchEmpty())
+    {
+        control_[index] = Empty;
+        ++growthLeft_;
+    }
+    else
+    {
+        control_[index] = Deleted;
+    }
+}
+
+SwissHashTable::ConstIterator SwissHashTable::begin() const
+{
+    return ConstIterator(this, 0);
+}
+
+SwissHashTable::ConstIterator SwissHashTable::end() const
+{
+    return ConstIterator(this, capacity_);
+}
+
+size_t SwissHashTable::Find(const std::string_view key, const uint64_t hash) const
+{
+    const int8_t fragment = H2(hash);
+    ProbeSequence probe(hash, capacity_);
+
+    while (true)
+    {
+        const Group group(control_ + probe.Offset());
+        for (BitMask match = group.Match(fragment); match; match.Next())
+        {
+            const size_t index = probe.Offset() + match.Lowest();
+            const SwissHashTableSlot &slot = slots_[index];
+            if (slot.hash == hash && slot.Entry().key.compare(key) == 0)
+            {
+                return index;
+            }
+        }
+
+        if (group.MatchEmpty())
+        {
+            return capacity_;
+        }
+
+        probe.Next();
+    }
+}
+
+size_t SwissHashTable::FindInsertSlot(const uint64_t hash) const
+{
+    ProbeSequence probe(hash, capacity_);
+
+    while (true)
+    {
+        const BitMask match = Group(control_ + probe.Offset()).MatchEmptyOrDeleted();
+        if (match)
+        {
+            return probe.Offset() + match.Lowest();
+        }
+
+        probe.Next();
+    }
+}
+
+void SwissHashTable::Rehash(const size_t capacity)
+{
+    const size_t oldCapacity = capacity_;
+    int8_t *oldControl = control_;
+    SwissHashTableSlot *oldSlots = slots_;
+
+    Allocate(capacity);
+    growthLeft_ -= count_;
+
+    // Entries are placed by their cached hash and moved, never rehashed.
+    for (size_t i = 0; i < oldCapacity; ++i)
+    {
+        if (oldControl[i] < 0)
+        {
+            continue;
+        }
+
+        SwissHashTableSlot &from = oldSlots[i];
+        const size_t index = FindInsertSlot(from.hash);
+        new (slots_[index].storage) HashTableEntry(std::move(from.Entry()));
+        slots_[index].hash = from.hash;
+        control_[index] = oldControl[i];
+        std::destroy_at(&from.Entry());
+    }
+
+    std::free(oldControl);
+    std::free(oldSlots);
+}
+
+void SwissHashTable::Allocate(const size_t capacity)
+{
+    capacity_ = capacity;
+    growthLeft_ = MaxLoad(capacity);
+
+    control_ = static_cast<int8_t *>(std::malloc(capacity));
+    slots_ = static_cast<SwissHashTableSlot *>(std::calloc(capacity, sizeof(SwissHashTableSlot)));
+    if (control_ == nullptr || slots_ == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    std::memset(control_, Empty, capacity);
+}
+
+SwissHashTable::ConstIterator::ConstIterator(const SwissHashTable *table, const size_t group) : table_(table), group_(group)
+{
+    if (group_ < table_->capacity_)
+    {
+        full_ = Group(table_->control_ + group_).MatchFull().Bits();
+        SkipEmptyGroups();
+    }
+}
+
+SwissHashTable::ConstIterator &SwissHashTable::ConstIterator::operator++()
+{
+    full_ &= full_ - 1;
+    SkipEmptyGroups();
+    return *this;
+}
+
+// The capacity is a multiple of the group width, so every load stays inside
+// the control bytes.
+void SwissHashTable::ConstIterator::SkipEmptyGroups()
+{
+    while (full_ == 0)
+    {
+        group_ += Group::Width;
+        if (group_ >= table_->capacity_)
+        {
+            group_ = table_->capacity_;
+            return;
+        }
+
+        full_ = Group(table_->control_ + group_).MatchFull().Bits();
+    }
+}
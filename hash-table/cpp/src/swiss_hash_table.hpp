@@ -0,0 +1,104 @@
+#ifndef SWISS_HASH_TABLE_HPP_
+#define SWISS_HASH_TABLE_HPP_
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <string_view>
+
+#include "hash.hpp"
+#include "hash_table.hpp"
+
+struct SwissHashTableSlot
+{
+    uint64_t hash;
+    alignas(HashTableEntry) unsigned char storage[sizeof(HashTableEntry)];
+
+    HashTableEntry &Entry() { return *std::launder(reinterpret_cast<HashTableEntry *>(storage)); }
+    const HashTableEntry &Entry() const { return *std::launder(reinterpret_cast<const HashTableEntry *>(storage)); }
+};
+
+// Open-addressing table in the style of Abseil's SwissTable. A separate array
+// of control bytes holds a 7-bit hash fragment per full slot, and lookups scan
+// a whole group of control bytes at once (16 with SSE2, 32 with AVX2), so the
+// full key is only compared on fragment matches.
+class SwissHashTable
+{
+public:
+    class ConstIterator;
+
+    SwissHashTable() : SwissHashTable(DefaultSize) {}
+    SwissHashTable(const size_t size, const HashFunction hash = WyHash);
+    SwissHashTable(const SwissHashTable &) = delete;
+    SwissHashTable &operator=(const SwissHashTable &) = delete;
+    ~SwissHashTable();
+
+    void Insert(const std::string_view key, const std::string_view value);
+    // Returns nullptr if key is absent.
+    const std::pmr::string *Search(const std::string_view key) const;
+    void Delete(const std::string_view key);
+    ConstIterator begin() const;
+    ConstIterator end() const;
+    size_t GetSize() const { return capacity_; }
+    size_t GetCount() const { return count_; }
+
+private:
+    size_t Find(const std::string_view key, const uint64_t hash) const;
+    size_t FindInsertSlot(const uint64_t hash) const;
+    void Rehash(const size_t capacity);
+    void Allocate(const size_t capacity);
+
+    static const size_t DefaultSize = 64;
+
+    HashFunction hash_;
+    size_t capacity_;
+    size_t count_;
+    size_t growthLeft_;
+    int8_t *control_;
+    SwissHashTableSlot *slots_;
+};
+
+// Forward iterator over the entries in slot order. It loads the control
+// bytes a group at a time and keeps a bitmask of the full slots left in the
+// current group, so runs of empty and deleted slots are skipped a whole
+// group per step. Insert and Delete invalidate it.
+class SwissHashTable::ConstIterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = HashTableEntry;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const HashTableEntry *;
+    using reference = const HashTableEntry &;
+
+    ConstIterator() = default;
+
+    reference operator*() const { return table_->slots_[group_ + std::countr_zero(full_)].Entry(); }
+    pointer operator->() const { return &**this; }
+    ConstIterator &operator++();
+    ConstIterator operator++(int)
+    {
+        ConstIterator old = *this;
+        ++*this;
+        return old;
+    }
+    bool operator==(const ConstIterator &other) const { return group_ == other.group_ && full_ == other.full_; }
+
+private:
+    friend class SwissHashTable;
+
+    ConstIterator(const SwissHashTable *table, const size_t group);
+    void SkipEmptyGroups();
+
+    const SwissHashTable *table_{};
+    // Offset of the current group, or the capacity at the end.
+    size_t group_{};
+    // Full slots of the current group not visited yet.
+    uint32_t full_{};
+};
+
+#endif
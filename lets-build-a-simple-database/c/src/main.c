@@ -1,17 +1,47 @@
+// POSIX.1-2001 for fseeko, ftruncate, fileno and posix_madvise, which glibc
+// hides under -std=c11. Not 2008, which declares a getline of its own.
+// A 64-bit off_t even on 32-bit systems, for files past 2 GiB.
+#define _POSIX_C_SOURCE 200112L
+#define _FILE_OFFSET_BITS 64
+
 #include <errno.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
+#include <threads.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 #define size_of_attribute(Struct, Attribute) sizeof(((Struct *)0)->Attribute)
+#define align_up(Size, Alignment) (((Size) + (Alignment) - 1) / (Alignment) * (Alignment))
+
+// stdin, read in large chunks straight from the descriptor rather than
+// through stdio, so that it is known whether more input is already waiting.
+typedef struct
+{
+    int32_t fd;
+    uint32_t start;
+    uint32_t end;
+    char data[65536];
+} input_stream_t;
 
 typedef struct
 {
     char *buffer;
     uint64_t buffer_length;
     int64_t input_length;
+    input_stream_t *stream;
 } input_buffer_t;
 
 typedef enum
@@ -38,7 +68,7 @@ typedef enum
 typedef enum
 {
     EXECUTE_SUCCESS,
-    EXECUTE_TABLE_FULL,
+    EXECUTE_DUPLICATE_KEY,
 } execute_result_t;
 
 #define COLUMN_USERNAME_SIZE 32
@@ -54,22 +84,153 @@ typedef struct
 {
     statement_type_t type;
     row_t row_to_insert;
+    // Inclusive id range a select prints; the whole table by default.
+    uint32_t select_first_id;
+    uint32_t select_last_id;
 } statement_t;
 
-#define TABLE_MAX_PAGES 100
+typedef enum
+{
+    PAGER_BUFFER_POOL,
+    PAGER_MMAP,
+} pager_mode_t;
+
+typedef enum
+{
+    ACCESS_NORMAL,
+    ACCESS_SEQUENTIAL,
+    ACCESS_RANDOM,
+} access_pattern_t;
+
+// A buffer pool frame. Pinned frames are in use and are never evicted.
+typedef struct
+{
+    uint32_t page_num; // INVALID_PAGE_NUM while the frame is free
+    uint32_t pin_count;
+    bool dirty;        // changed since it was last written
+    bool referenced;   // CLOCK's second chance, set on every pin
+} frame_t;
+
+// A log frame header. Page frames are followed by the page image. A commit
+// frame makes every frame before it durable.
+typedef struct
+{
+    uint32_t magic;
+    uint32_t type;
+    uint32_t page_num; // commit frames: number of pages in the database
+    uint32_t checksum; // of the rest of the header and the page image
+    uint64_t generation;
+} wal_frame_header_t;
+
+typedef struct
+{
+    char *path;
+    FILE *file;            // appended to and read by the main thread
+    FILE *checkpoint_file; // read by the checkpoint thread
+    bool appending;        // file is positioned at length
+    uint64_t generation;
+    int64_t length;
+    // Offset plus one of the latest frame of each page, or 0.
+    uint64_t *page_offsets;
+    uint32_t max_pages;
+} wal_log_t;
+
+// Write-ahead log. The database file only changes at checkpoints, which
+// copy the latest image of every page in a log into it; until then pages
+// are read from the log. There are two logs: while the checkpoint thread
+// copies a full one into the database, statements go on appending to the
+// other.
+typedef struct
+{
+    FILE *db_file; // the checkpoint thread's handle on the database
+    wal_log_t logs[2];
+    uint32_t active;
+    uint32_t frozen;  // the log being checkpointed, if has_frozen
+    bool has_frozen;
+    uint32_t num_uncommitted_frames;
+    thrd_t thread;
+    mtx_t lock;
+    cnd_t changed;
+    bool checkpoint_requested; // guarded by lock
+    bool stopping;             // guarded by lock
+} wal_t;
+
+// In PAGER_BUFFER_POOL mode, keeps at most num_frames pages in memory,
+// however large the file. When a page is needed and every frame is taken,
+// the CLOCK hand sweeps the frames for one that is neither pinned nor
+// recently used, writing it back first if it is dirty.
+//
+// In PAGER_MMAP mode, pages are read and written in place in a shared
+// mapping of the file, and the kernel's page cache does the rest. A commit
+// forces the mapping to disk, but the kernel may also write pages back at
+// any moment in between and there is no log, so a crash in the middle of a
+// split can leave a torn tree. Only the buffer pool is crash-safe.
 typedef struct
 {
     FILE *file;
-    uint32_t file_length;
-    void *pages[TABLE_MAX_PAGES];
+    pager_mode_t mode;
+    wal_t *wal; // PAGER_BUFFER_POOL only
+    uint32_t num_pages;
+    uint32_t num_frames;
+    uint32_t clock_hand;
+    frame_t *frames;
+    void *frame_data;
+    // Frame of each page plus one, or 0 if the page is not in memory. At 4
+    // bytes per page it grows with the file but stays a thousandth of it.
+    uint32_t *page_frames;
+    uint32_t max_pages;
+    // The file is mapped map_pages long, ahead of num_pages, and cut back to
+    // num_pages on close.
+    void *map;
+    uint32_t map_pages;
+    uint32_t num_pinned;
+    bool map_changed; // written since the last sync
+    access_pattern_t access_pattern;
+#ifdef _WIN32
+    HANDLE map_handle;
+#endif
 } pager_t;
 
+// The root is always page 0: splitting it moves its cells to a new page and
+// turns page 0 into the new internal root.
 typedef struct
 {
     pager_t *pager;
-    uint32_t num_rows;
+    uint32_t root_page_num;
 } table_t;
 
+// Position of a row in the leaf level, which is linked left to right in id
+// order.
+typedef struct
+{
+    table_t *table;
+    uint32_t page_num;
+    uint32_t cell_num;
+    bool end_of_table; // one position past the last row
+} cursor_t;
+
+#define BULK_LOAD_MAX_DEPTH 32
+
+// The right edge of the tree, from the rightmost leaf up to the root. A row
+// whose id is above every other one is appended there without a search,
+// and each leaf is filled before the next is started, so loading rows in id
+// order builds the tree bottom-up out of full pages with no splits.
+typedef struct
+{
+    table_t *table;
+    bool valid; // false once something else may have changed the tree
+    bool empty; // no rows yet, so any id can be appended
+    uint32_t max_key;
+    uint32_t depth;
+    uint32_t page_nums[BULK_LOAD_MAX_DEPTH]; // the leaf first, the root last
+} bulk_loader_t;
+
+typedef enum
+{
+    NODE_INTERNAL,
+    NODE_LEAF,
+} node_type_t;
+
 const uint32_t ID_SIZE = size_of_attribute(row_t, id);
 const uint32_t USERNAME_SIZE = size_of_attribute(row_t, username);
 const uint32_t EMAIL_SIZE = size_of_attribute(row_t, email);
@@ -79,10 +240,129 @@ const uint32_t EMAIL_OFFSET = USERNAME_OFFSET + USERNAME_SIZE;
 const uint32_t ROW_SIZE = ID_SIZE + USERNAME_SIZE + EMAIL_SIZE;
 
 const uint32_t PAGE_SIZE = 4096;
-const uint32_t ROWS_PER_PAGE = PAGE_SIZE / ROW_SIZE;
-const uint32_t TABLE_MAX_ROWS = ROWS_PER_PAGE * TABLE_MAX_PAGES;
+const uint32_t INVALID_PAGE_NUM = UINT32_MAX;
+
+// Buffer pool size in frames, set by the optional second argument. An insert
+// that splits the tree all the way up pins at most a handful of pages at a
+// time, so a few frames are enough to work, just slowly.
+const uint32_t DEFAULT_NUM_FRAMES = 2048;
+const uint32_t MIN_NUM_FRAMES = 8;
+
+// The mapping grows in 16 MiB extents. It can only move while nothing is
+// pinned, so it is grown between statements whenever fewer than
+// MMAP_HEADROOM_PAGES are left, which is more than one insert can allocate
+// even when it splits every level of the tree.
+const uint32_t MMAP_EXTENT_PAGES = 4096;
+const uint32_t MMAP_HEADROOM_PAGES = 64;
+
+const uint32_t WAL_MAGIC = 0x57414c31; // "WAL1"
+const uint32_t WAL_FRAME_PAGE = 1;
+const uint32_t WAL_FRAME_COMMIT = 2;
+const uint32_t WAL_FRAME_HEADER_SIZE = sizeof(wal_frame_header_t);
+// Once a commit takes the active log past this, it is checkpointed.
+const int64_t WAL_CHECKPOINT_BYTES = 64 * 1024 * 1024;
+// Statements waiting for one commit at most. Their acknowledgements sit in
+// stdout's buffer meanwhile, so this keeps them well inside it.
+const uint32_t GROUP_COMMIT_MAX_STATEMENTS = 1024;
+// Rows an import or a batch run loads per commit. A log only goes to the
+// checkpoint thread at a commit, so this keeps the log from growing to the
+// size of the whole load.
+const uint32_t BULK_COMMIT_ROWS = 1 << 16;
+const uint32_t STDOUT_BUFFER_SIZE = 1 << 20;
+
+// Common node header layout. Nodes are read and written in place through
+// uint32_t pointers, so the header and cells are padded to keep every such
+// field 4-byte aligned within the page.
+const uint32_t NODE_FIELD_ALIGNMENT = sizeof(uint32_t);
+const uint32_t NODE_TYPE_SIZE = sizeof(uint8_t);
+const uint32_t NODE_TYPE_OFFSET = 0;
+const uint32_t IS_ROOT_SIZE = sizeof(uint8_t);
+const uint32_t IS_ROOT_OFFSET = NODE_TYPE_OFFSET + NODE_TYPE_SIZE;
+const uint32_t PARENT_POINTER_SIZE = sizeof(uint32_t);
+const uint32_t PARENT_POINTER_OFFSET = align_up(IS_ROOT_OFFSET + IS_ROOT_SIZE, NODE_FIELD_ALIGNMENT);
+const uint32_t COMMON_NODE_HEADER_SIZE = PARENT_POINTER_OFFSET + PARENT_POINTER_SIZE;
+
+// Leaf node header layout. next_leaf is 0 for the last leaf, since page 0
+// is always the root.
+const uint32_t LEAF_NODE_NUM_CELLS_SIZE = sizeof(uint32_t);
+const uint32_t LEAF_NODE_NUM_CELLS_OFFSET = COMMON_NODE_HEADER_SIZE;
+const uint32_t LEAF_NODE_NEXT_LEAF_SIZE = sizeof(uint32_t);
+const uint32_t LEAF_NODE_NEXT_LEAF_OFFSET = LEAF_NODE_NUM_CELLS_OFFSET + LEAF_NODE_NUM_CELLS_SIZE;
+const uint32_t LEAF_NODE_HEADER_SIZE = COMMON_NODE_HEADER_SIZE + LEAF_NODE_NUM_CELLS_SIZE + LEAF_NODE_NEXT_LEAF_SIZE;
+
+// Leaf node body layout: cells of key and row, sorted by key
+const uint32_t LEAF_NODE_KEY_SIZE = sizeof(uint32_t);
+const uint32_t LEAF_NODE_KEY_OFFSET = 0;
+const uint32_t LEAF_NODE_VALUE_OFFSET = LEAF_NODE_KEY_OFFSET + LEAF_NODE_KEY_SIZE;
+const uint32_t LEAF_NODE_CELL_SIZE = align_up(LEAF_NODE_KEY_SIZE + ROW_SIZE, NODE_FIELD_ALIGNMENT);
+const uint32_t LEAF_NODE_SPACE_FOR_CELLS = PAGE_SIZE - LEAF_NODE_HEADER_SIZE;
+const uint32_t LEAF_NODE_MAX_CELLS = LEAF_NODE_SPACE_FOR_CELLS / LEAF_NODE_CELL_SIZE;
+const uint32_t LEAF_NODE_RIGHT_SPLIT_COUNT = (LEAF_NODE_MAX_CELLS + 1) / 2;
+const uint32_t LEAF_NODE_LEFT_SPLIT_COUNT = (LEAF_NODE_MAX_CELLS + 1) - LEAF_NODE_RIGHT_SPLIT_COUNT;
+
+// Internal node header layout
+const uint32_t INTERNAL_NODE_NUM_KEYS_SIZE = sizeof(uint32_t);
+const uint32_t INTERNAL_NODE_NUM_KEYS_OFFSET = COMMON_NODE_HEADER_SIZE;
+const uint32_t INTERNAL_NODE_RIGHT_CHILD_SIZE = sizeof(uint32_t);
+const uint32_t INTERNAL_NODE_RIGHT_CHILD_OFFSET = INTERNAL_NODE_NUM_KEYS_OFFSET + INTERNAL_NODE_NUM_KEYS_SIZE;
+const uint32_t INTERNAL_NODE_HEADER_SIZE = COMMON_NODE_HEADER_SIZE + INTERNAL_NODE_NUM_KEYS_SIZE + INTERNAL_NODE_RIGHT_CHILD_SIZE;
+
+// Internal node body layout: cells of child page and the largest key in
+// that child, sorted by key. Keys above the last one are in the right child.
+const uint32_t INTERNAL_NODE_CHILD_SIZE = sizeof(uint32_t);
+const uint32_t INTERNAL_NODE_KEY_SIZE = sizeof(uint32_t);
+const uint32_t INTERNAL_NODE_CELL_SIZE = INTERNAL_NODE_CHILD_SIZE + INTERNAL_NODE_KEY_SIZE;
+const uint32_t INTERNAL_NODE_MAX_KEYS = (PAGE_SIZE - INTERNAL_NODE_HEADER_SIZE) / INTERNAL_NODE_CELL_SIZE;
+
+int32_t input_getc(input_stream_t *stream)
+{
+    if (stream->start == stream->end)
+    {
+#ifdef _WIN32
+        int64_t bytes_read = _read(stream->fd, stream->data, sizeof(stream->data));
+#else
+        int64_t bytes_read = read(stream->fd, stream->data, sizeof(stream->data));
+#endif
+        if (bytes_read <= 0)
+        {
+            return EOF;
+        }
+
+        stream->start = 0;
+        stream->end = (uint32_t)bytes_read;
+    }
+
+    return (uint8_t)stream->data[stream->start++];
+}
+
+// Whether reading more input would return without waiting. A regular file
+// always would; a terminal is only polled on POSIX.
+bool input_pending(input_stream_t *stream)
+{
+    if (stream->start < stream->end)
+    {
+        return true;
+    }
+
+#ifdef _WIN32
+    HANDLE handle = (HANDLE)_get_osfhandle(stream->fd);
+    DWORD available = 0;
+    switch (GetFileType(handle))
+    {
+    case FILE_TYPE_DISK:
+        return true;
+    case FILE_TYPE_PIPE:
+        return PeekNamedPipe(handle, NULL, 0, NULL, &available, NULL) && available > 0;
+    default:
+        return false;
+    }
+#else
+    struct pollfd pollfd = {stream->fd, POLLIN, 0};
+    return poll(&pollfd, 1, 0) > 0;
+#endif
+}
 
-int64_t getline(char **lineptr, int64_t *n, FILE *stream)
+int64_t getline(char **lineptr, int64_t *n, input_stream_t *stream)
 {
     char *buf_ptr = NULL;
     char *p = buf_ptr;
@@ -97,7 +377,7 @@ int64_t getline(char **lineptr, int64_t *n, FILE *stream)
     buf_ptr = *lineptr;
     size = *n;
 
-    c = fgetc(stream);
+    c = input_getc(stream);
     if (c == EOF)
     {
         return -1;
@@ -131,7 +411,7 @@ int64_t getline(char **lineptr, int64_t *n, FILE *stream)
         {
             break;
         }
-        c = fgetc(stream);
+        c = input_getc(stream);
     }
 
     *p++ = '\0';
@@ -147,325 +427,2119 @@ input_buffer_t *create_input_buffer()
     input_buffer->buffer = NULL;
     input_buffer->buffer_length = 0;
     input_buffer->input_length = 0;
+    input_buffer->stream = malloc(sizeof(input_stream_t));
+    input_buffer->stream->fd = 0;
+    input_buffer->stream->start = 0;
+    input_buffer->stream->end = 0;
     return input_buffer;
 }
 
 void close_input_buffer(input_buffer_t *input_buffer)
 {
     free(input_buffer->buffer);
+    free(input_buffer->stream);
     free(input_buffer);
 }
 
-pager_t *pager_open(const char *filename)
+// Plain fseek/ftell take a long, which is 32 bits on Windows, so files past
+// 2 GiB need the 64-bit variants.
+int32_t file_seek(FILE *file, int64_t offset, int32_t origin)
 {
-    FILE *file = fopen(filename, "r+t");
-    if (file == NULL)
-    {
-        file = fopen(filename, "w+t");
-        if (file == NULL)
-        {
-            printf("Unable to open file\n");
-            exit(EXIT_FAILURE);
-        }
-    }
+#ifdef _WIN32
+    return _fseeki64(file, offset, origin);
+#else
+    return fseeko(file, (off_t)offset, origin);
+#endif
+}
+
+#ifndef _WIN32
+_Static_assert(sizeof(off_t) == sizeof(int64_t), "off_t must be 64 bits");
+#endif
+
+int64_t file_tell(FILE *file)
+{
+#ifdef _WIN32
+    return _ftelli64(file);
+#else
+    return ftello(file);
+#endif
+}
 
-    int32_t result = fseek(file, 0, SEEK_END);
+// Sets the file's length, filling any new part with zeros.
+int32_t file_truncate(FILE *file, int64_t length)
+{
+#ifdef _WIN32
+    return _chsize_s(_fileno(file), length);
+#else
+    return ftruncate(fileno(file), (off_t)length);
+#endif
+}
+
+// Flushes the stream and forces the file's contents to disk.
+void file_sync(FILE *file)
+{
+#ifdef _WIN32
+    int32_t result = fflush(file) || _commit(_fileno(file));
+#else
+    int32_t result = fflush(file) || fsync(fileno(file));
+#endif
     if (result)
     {
-        printf("Error seeking: %d\n", errno);
+        printf("Error syncing file: %d\n", errno);
         exit(EXIT_FAILURE);
     }
+}
 
-    off_t file_length = ftell(file);
-    if (file_length < 0)
+// Forces the directory entry of a newly created file to disk, without which
+// a power loss can drop the file along with everything synced to it. NTFS
+// journals the entry itself, so there is nothing to do on Windows.
+void directory_sync(const char *path)
+{
+#ifndef _WIN32
+    const char *slash = strrchr(path, '/');
+    size_t length = slash == NULL ? 0 : slash == path ? 1 : (size_t)(slash - path);
+    char *directory = malloc(length + sizeof("."));
+    if (slash == NULL)
     {
-        printf("Error seeking: %d\n", errno);
-        exit(EXIT_FAILURE);
+        strcpy(directory, ".");
     }
-
-    pager_t *pager = malloc(sizeof(pager_t));
-    pager->file = file;
-    pager->file_length = file_length;
-
-    for (uint32_t i = 0; i < TABLE_MAX_PAGES; ++i)
+    else
     {
-        pager->pages[i] = NULL;
+        memcpy(directory, path, length);
+        directory[length] = '\0';
     }
-
-    return pager;
+    int fd = open(directory, O_RDONLY);
+    int32_t result = fd < 0 || fsync(fd);
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    if (result)
+    {
+        printf("Error syncing directory %s: %d\n", directory, errno);
+        exit(EXIT_FAILURE);
+    }
+    free(directory);
+#endif
 }
 
-void *get_page(pager_t *pager, uint32_t page_num)
+// Fletcher-style sum over 32-bit words, as SQLite uses for its log: cheap,
+// and a torn frame or one left over from an older log fails it.
+uint32_t wal_checksum(wal_frame_header_t *header, void *page)
 {
-    if (page_num > TABLE_MAX_PAGES)
+    uint32_t words[] = {header->magic, header->type, header->page_num, (uint32_t)header->generation,
+                        (uint32_t)(header->generation >> 32)};
+    uint32_t s1 = 0;
+    uint32_t s2 = 0;
+    for (uint32_t i = 0; i < sizeof(words) / sizeof(uint32_t); ++i)
     {
-        printf("Tried to fetch page number out of bounds. %d > %d\n", page_num, TABLE_MAX_PAGES);
-        exit(EXIT_FAILURE);
+        s1 += words[i] + s2;
+        s2 += s1;
     }
 
-    if (pager->pages[page_num] == NULL)
+    if (page != NULL)
     {
-        void *page = malloc(PAGE_SIZE);
-        uint32_t num_pages = pager->file_length / PAGE_SIZE;
-
-        if (pager->file_length % PAGE_SIZE)
+        uint32_t *page_words = page;
+        for (uint32_t i = 0; i < PAGE_SIZE / sizeof(uint32_t); ++i)
         {
-            num_pages += 1;
+            s1 += page_words[i] + s2;
+            s2 += s1;
         }
+    }
+
+    return s1 ^ s2;
+}
+
+uint64_t wal_log_find(wal_log_t *log, uint32_t page_num)
+{
+    return page_num < log->max_pages ? log->page_offsets[page_num] : 0;
+}
 
-        if (page_num <= num_pages)
+void wal_log_set(wal_log_t *log, uint32_t page_num, uint64_t offset)
+{
+    if (page_num >= log->max_pages)
+    {
+        uint32_t max_pages = log->max_pages == 0 ? 64 : log->max_pages;
+        while (page_num >= max_pages)
         {
-            fseek(pager->file, page_num * PAGE_SIZE, SEEK_SET);
-            int64_t bytes_read = fread(page, sizeof(uint8_t), PAGE_SIZE, pager->file);
-            if (bytes_read < 0 || ferror(pager->file))
-            {
-                printf("Error reading file: %d\n", errno);
-                exit(EXIT_FAILURE);
-            }
+            max_pages *= 2;
         }
 
-        pager->pages[page_num] = page;
+        log->page_offsets = realloc(log->page_offsets, max_pages * sizeof(uint64_t));
+        memset(log->page_offsets + log->max_pages, 0, (max_pages - log->max_pages) * sizeof(uint64_t));
+        log->max_pages = max_pages;
     }
 
-    return pager->pages[page_num];
+    log->page_offsets[page_num] = offset;
 }
 
-void pager_flush(pager_t *pager, uint32_t page_num, uint32_t size)
+// Empties the log. Its frames must already be in the database file.
+void wal_log_reset(wal_log_t *log)
 {
-    if (pager->pages[page_num] == NULL)
+    if (file_truncate(log->file, 0))
     {
-        printf("Tried to flush null page\n");
+        printf("Error truncating log: %d\n", errno);
         exit(EXIT_FAILURE);
     }
+    file_sync(log->file);
 
-    off_t offset = fseek(pager->file, page_num * PAGE_SIZE, SEEK_SET);
-    if (offset)
+    if (log->page_offsets != NULL)
     {
-        printf("Error seeking: %d\n", errno);
-        exit(EXIT_FAILURE);
+        memset(log->page_offsets, 0, log->max_pages * sizeof(uint64_t));
     }
+    log->length = 0;
+    log->appending = false;
+}
 
-    int64_t bytes_written = fwrite(pager->pages[page_num], sizeof(uint8_t), size, pager->file);
-    if (bytes_written < size)
+void wal_log_open(wal_log_t *log, const char *filename, uint32_t log_num)
+{
+    log->path = malloc(strlen(filename) + sizeof("-wal0"));
+    sprintf(log->path, "%s-wal%u", filename, log_num);
+
+    log->file = fopen(log->path, "r+b");
+    if (log->file == NULL)
+    {
+        log->file = fopen(log->path, "w+b");
+        if (log->file != NULL)
+        {
+            directory_sync(log->path);
+        }
+    }
+    log->checkpoint_file = log->file == NULL ? NULL : fopen(log->path, "rb");
+    if (log->checkpoint_file == NULL)
     {
-        printf("Error writing: %d\n", errno);
+        printf("Unable to open log file %s\n", log->path);
         exit(EXIT_FAILURE);
     }
-}
 
-void print_prompt()
-{
-    printf("db > ");
+    // The log is truncated and rewritten under this handle, and a buffered
+    // stream may serve a seek from bytes it read before.
+    setvbuf(log->checkpoint_file, NULL, _IONBF, 0);
+
+    log->appending = false;
+    log->generation = 0;
+    log->length = 0;
+    log->page_offsets = NULL;
+    log->max_pages = 0;
 }
 
-void read_input(input_buffer_t *input_buffer)
+void wal_append(wal_log_t *log, uint32_t type, uint32_t page_num, void *page)
 {
-    int64_t bytes_read = getline(&(input_buffer->buffer), &(input_buffer->buffer_length), stdin);
-    if (bytes_read <= 0)
+    wal_frame_header_t header = {WAL_MAGIC, type, page_num, 0, log->generation};
+    header.checksum = wal_checksum(&header, page);
+
+    // Reads move the position, and stdio needs a seek between a read and
+    // a write anyway.
+    if (!log->appending)
+    {
+        file_seek(log->file, log->length, SEEK_SET);
+        log->appending = true;
+    }
+
+    if (fwrite(&header, WAL_FRAME_HEADER_SIZE, 1, log->file) != 1 ||
+        (page != NULL && fwrite(page, PAGE_SIZE, 1, log->file) != 1))
     {
-        printf("Error reading input\n");
+        printf("Error writing log: %d\n", errno);
         exit(EXIT_FAILURE);
     }
 
-    input_buffer->input_length = bytes_read - 1;
-    input_buffer->buffer[bytes_read - 1] = '\0';
+    if (page != NULL)
+    {
+        wal_log_set(log, page_num, (uint64_t)log->length + 1);
+    }
+    log->length += WAL_FRAME_HEADER_SIZE + (page != NULL ? PAGE_SIZE : 0);
 }
 
-void serialize_row(row_t *source, void *destination)
+void wal_read_page(FILE *log_file, uint64_t offset, void *page)
 {
-    memcpy(destination + ID_OFFSET, &(source->id), ID_SIZE);
-    strncpy(destination + USERNAME_OFFSET, &(source->username), USERNAME_SIZE);
-    strncpy(destination + EMAIL_OFFSET, &(source->email), EMAIL_SIZE);
+    file_seek(log_file, (int64_t)(offset - 1) + WAL_FRAME_HEADER_SIZE, SEEK_SET);
+    if (fread(page, PAGE_SIZE, 1, log_file) != 1)
+    {
+        printf("Error reading log: %d\n", errno);
+        exit(EXIT_FAILURE);
+    }
 }
 
-void deserialize_row(void *source, row_t *destination)
+// Copies the latest image of every page in the log into the database file
+// and syncs it. Copying a page twice is harmless, so recovery simply redoes
+// a checkpoint that a crash cut short.
+void wal_checkpoint_log(wal_log_t *log, FILE *log_file, FILE *db_file)
 {
-    memcpy(&(destination->id), source + ID_OFFSET, ID_SIZE);
-    memcpy(&(destination->username), source + USERNAME_OFFSET, USERNAME_SIZE);
-    memcpy(&(destination->email), source + EMAIL_OFFSET, EMAIL_SIZE);
+    void *page = malloc(PAGE_SIZE);
+
+    for (uint32_t page_num = 0; page_num < log->max_pages; ++page_num)
+    {
+        uint64_t offset = log->page_offsets[page_num];
+        if (offset == 0)
+        {
+            continue;
+        }
+
+        wal_read_page(log_file, offset, page);
+        file_seek(db_file, (int64_t)page_num * PAGE_SIZE, SEEK_SET);
+        if (fwrite(page, PAGE_SIZE, 1, db_file) != 1)
+        {
+            printf("Error writing: %d\n", errno);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    free(page);
+    file_sync(db_file);
 }
 
-void *row_slot(table_t *table, uint32_t row_num)
+int32_t wal_checkpoint_thread(void *arg)
 {
-    uint32_t page_num = row_num / ROWS_PER_PAGE;
-    void *page = get_page(table->pager, page_num);
-    uint32_t row_offset = row_num % ROWS_PER_PAGE;
-    uint32_t byte_offset = row_offset * ROW_SIZE;
-    return page + byte_offset;
+    wal_t *wal = arg;
+
+    mtx_lock(&wal->lock);
+    while (1)
+    {
+        while (!wal->checkpoint_requested && !wal->stopping)
+        {
+            cnd_wait(&wal->changed, &wal->lock);
+        }
+
+        // A requested checkpoint is finished even when stopping.
+        if (!wal->checkpoint_requested)
+        {
+            break;
+        }
+
+        wal_log_t *log = &wal->logs[wal->frozen];
+        mtx_unlock(&wal->lock);
+        wal_checkpoint_log(log, log->checkpoint_file, wal->db_file);
+        mtx_lock(&wal->lock);
+
+        wal->checkpoint_requested = false;
+        cnd_broadcast(&wal->changed);
+    }
+    mtx_unlock(&wal->lock);
+
+    return 0;
 }
 
-void print_row(row_t *row)
+void wal_wait_for_checkpoint(wal_t *wal)
 {
-    printf("(%d, %s, %s)\n", row->id, row->username, row->email);
+    mtx_lock(&wal->lock);
+    while (wal->checkpoint_requested)
+    {
+        cnd_wait(&wal->changed, &wal->lock);
+    }
+    mtx_unlock(&wal->lock);
 }
 
-table_t *db_open(const char *filename)
+// Hands the active log, which ends in a commit, to the checkpoint thread and
+// continues in the other one, once that one's own checkpoint is done.
+void wal_switch(wal_t *wal)
 {
-    pager_t *pager = pager_open(filename);
-    uint32_t num_rows = pager->file_length / ROW_SIZE;
+    wal_wait_for_checkpoint(wal);
+    if (wal->has_frozen)
+    {
+        wal_log_reset(&wal->logs[wal->frozen]);
+    }
 
-    table_t *table = malloc(sizeof(table_t));
-    table->pager = pager;
-    table->num_rows = num_rows;
+    uint32_t next = 1 - wal->active;
+    wal->logs[next].generation = wal->logs[wal->active].generation + 1;
 
-    return table;
+    mtx_lock(&wal->lock);
+    wal->frozen = wal->active;
+    wal->active = next;
+    wal->checkpoint_requested = true;
+    cnd_broadcast(&wal->changed);
+    mtx_unlock(&wal->lock);
+
+    wal->has_frozen = true;
 }
 
-void db_close(table_t *table)
+// Walks the valid frames of a log left behind by a crash and returns where
+// its last commit ends. Frames past that belong to statements that were
+// never acknowledged. Page frames before index_below are indexed.
+int64_t wal_scan_log(wal_log_t *log, int64_t index_below)
 {
-    pager_t *pager = table->pager;
-    uint32_t num_full_pages = table->num_rows / ROWS_PER_PAGE;
-
-    for (uint32_t i = 0; i < num_full_pages; ++i)
+    void *page = malloc(PAGE_SIZE);
+    wal_frame_header_t header;
+    int64_t offset = 0;
+    int64_t committed_length = 0;
+
+    file_seek(log->file, 0, SEEK_SET);
+    log->appending = false;
+    while (fread(&header, WAL_FRAME_HEADER_SIZE, 1, log->file) == 1)
     {
-        if (pager->pages[i] == NULL)
+        bool is_page = header.type == WAL_FRAME_PAGE;
+        if (header.magic != WAL_MAGIC || (!is_page && header.type != WAL_FRAME_COMMIT) ||
+            (offset > 0 && header.generation != log->generation))
         {
-            continue;
+            break;
         }
 
-        pager_flush(pager, i, PAGE_SIZE);
-        free(pager->pages[i]);
-        pager->pages[i] = NULL;
-    }
+        if (is_page && fread(page, PAGE_SIZE, 1, log->file) != 1)
+        {
+            break;
+        }
 
-    uint32_t num_additional_rows = table->num_rows % ROWS_PER_PAGE;
-    if (num_additional_rows > 0)
-    {
-        uint32_t page_num = num_full_pages;
-        if (pager->pages[page_num] != NULL)
+        uint32_t checksum = header.checksum;
+        header.checksum = 0;
+        if (checksum != wal_checksum(&header, is_page ? page : NULL))
         {
-            pager_flush(pager, page_num, num_additional_rows * ROW_SIZE);
-            free(pager->pages[page_num]);
-            pager->pages[page_num] = NULL;
+            break;
         }
-    }
 
-    int32_t result = fclose(pager->file);
-    if (result)
-    {
-        printf("Error closing db file.\n");
-        exit(EXIT_FAILURE);
-    }
+        log->generation = header.generation;
+        if (is_page && offset < index_below)
+        {
+            wal_log_set(log, header.page_num, (uint64_t)offset + 1);
+        }
 
-    for (uint32_t i = 0; i < TABLE_MAX_PAGES; ++i)
-    {
-        void *page = pager->pages[i];
-        if (page)
+        offset += WAL_FRAME_HEADER_SIZE + (is_page ? PAGE_SIZE : 0);
+        if (!is_page)
         {
-            free(page);
-            pager->pages[i] = NULL;
+            committed_length = offset;
         }
     }
 
-    free(pager);
-    free(table);
+    free(page);
+    return committed_length;
 }
 
-meta_command_result_t do_meta_command(input_buffer_t *input_buffer, table_t *table)
+// Brings the database file up to the last commit in the logs, the older
+// log first, and empties them.
+void wal_recover(wal_t *wal)
 {
-    if (strcmp(input_buffer->buffer, ".exit") == 0)
+    int64_t committed_lengths[2];
+    for (uint32_t i = 0; i < 2; ++i)
     {
-        db_close(table);
-        exit(EXIT_SUCCESS);
+        committed_lengths[i] = wal_scan_log(&wal->logs[i], 0);
+        wal_scan_log(&wal->logs[i], committed_lengths[i]);
     }
-    else
+
+    uint32_t first = wal->logs[0].generation <= wal->logs[1].generation ? 0 : 1;
+    for (uint32_t i = first; i < first + 2; ++i)
     {
-        return META_COMMAND_UNRECOGNIZED_COMMAND;
+        wal_log_t *log = &wal->logs[i % 2];
+        if (committed_lengths[i % 2] > 0)
+        {
+            wal_checkpoint_log(log, log->file, wal->db_file);
+        }
     }
-}
-
-prepare_result_t prepare_insert(input_buffer_t *input_buffer, statement_t *statement)
-{
-    statement->type = STATEMENT_INSERT;
-
-    char *keyword = strtok(input_buffer->buffer, " ");
-    char *id_string = strtok(NULL, " ");
-    char *username = strtok(NULL, " ");
-    char *email = strtok(NULL, " ");
 
-    if (id_string == NULL || username == NULL || email == NULL)
+    for (uint32_t i = 0; i < 2; ++i)
     {
-        return PREPARE_SYNTAX_ERROR;
+        wal_log_reset(&wal->logs[i]);
+        wal->logs[i].generation = 0;
     }
+}
 
-    int id = atoi(id_string);
-    if (id < 0)
+// Opens the logs next to the database file, recovering whatever a crash
+// left in them, and starts the checkpoint thread.
+wal_t *wal_open(const char *filename)
+{
+    wal_t *wal = malloc(sizeof(wal_t));
+    wal->db_file = fopen(filename, "r+b");
+    if (wal->db_file == NULL)
     {
-        return PREPARE_NEGATIVE_ID;
+        printf("Unable to open file\n");
+        exit(EXIT_FAILURE);
     }
 
-    if (strlen(username) > COLUMN_USERNAME_SIZE)
+    for (uint32_t i = 0; i < 2; ++i)
     {
-        return PREPARE_STRING_TOO_LONG;
+        wal_log_open(&wal->logs[i], filename, i);
     }
-
-    if (strlen(email) > COLUMN_EMAIL_SIZE)
+    wal_recover(wal);
+
+    wal->active = 0;
+    wal->frozen = 1;
+    wal->has_frozen = false;
+    wal->num_uncommitted_frames = 0;
+    wal->logs[0].generation = 1;
+    wal->checkpoint_requested = false;
+    wal->stopping = false;
+
+    if (mtx_init(&wal->lock, mtx_plain) != thrd_success || cnd_init(&wal->changed) != thrd_success ||
+        thrd_create(&wal->thread, wal_checkpoint_thread, wal) != thrd_success)
     {
-        return PREPARE_STRING_TOO_LONG;
+        printf("Unable to start checkpoint thread\n");
+        exit(EXIT_FAILURE);
     }
 
-    statement->row_to_insert.id = id;
-    strcpy(statement->row_to_insert.username, username);
-    strcpy(statement->row_to_insert.email, email);
-
-    return PREPARE_SUCCESS;
+    return wal;
 }
 
-prepare_result_t prepare_statement(input_buffer_t *input_buffer, statement_t *statement)
+// Stops the checkpoint thread, checkpoints what is left and removes the
+// logs. Everything must be committed.
+void wal_close(wal_t *wal)
 {
-    if (strncmp(input_buffer->buffer, "insert", 6) == 0)
+    mtx_lock(&wal->lock);
+    wal->stopping = true;
+    cnd_broadcast(&wal->changed);
+    mtx_unlock(&wal->lock);
+    thrd_join(wal->thread, NULL);
+
+    wal_log_t *active = &wal->logs[wal->active];
+    wal_checkpoint_log(active, active->file, wal->db_file);
+
+    for (uint32_t i = 0; i < 2; ++i)
     {
-        return prepare_insert(input_buffer, statement);
+        wal_log_t *log = &wal->logs[i];
+        fclose(log->checkpoint_file);
+        if (fclose(log->file) || remove(log->path))
+        {
+            printf("Error removing log file %s\n", log->path);
+            exit(EXIT_FAILURE);
+        }
+        free(log->path);
+        free(log->page_offsets);
     }
 
-    if (strcmp(input_buffer->buffer, "select") == 0)
+    if (fclose(wal->db_file))
     {
-        statement->type = STATEMENT_SELECT;
-        return PREPARE_SUCCESS;
+        printf("Error closing db file.\n");
+        exit(EXIT_FAILURE);
     }
 
-    return PREPARE_UNRECOGNIZED_STATEMENT;
+    mtx_destroy(&wal->lock);
+    cnd_destroy(&wal->changed);
+    free(wal);
 }
 
-execute_result_t execute_insert(statement_t *statement, table_t *table)
+// Grows the file to map_pages pages and maps all of it.
+void pager_map(pager_t *pager, uint32_t map_pages)
 {
-    if (table->num_rows >= TABLE_MAX_ROWS)
+    int64_t length = (int64_t)map_pages * PAGE_SIZE;
+    if (file_truncate(pager->file, length))
     {
-        return EXECUTE_TABLE_FULL;
+        printf("Error growing file: %d\n", errno);
+        exit(EXIT_FAILURE);
     }
 
-    row_t *row_to_insert = &(statement->row_to_insert);
+#ifdef _WIN32
+    HANDLE file = (HANDLE)_get_osfhandle(_fileno(pager->file));
+    pager->map_handle = CreateFileMappingA(file, NULL, PAGE_READWRITE, 0, 0, NULL);
+    pager->map = pager->map_handle == NULL ? NULL : MapViewOfFile(pager->map_handle, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    if (pager->map == NULL)
+    {
+        printf("Error mapping file: %lu\n", GetLastError());
+        exit(EXIT_FAILURE);
+    }
+#else
+    pager->map = mmap(NULL, (size_t)length, PROT_READ | PROT_WRITE, MAP_SHARED, fileno(pager->file), 0);
+    if (pager->map == MAP_FAILED)
+    {
+        printf("Error mapping file: %d\n", errno);
+        exit(EXIT_FAILURE);
+    }
+#endif
 
-    serialize_row(row_to_insert, row_slot(table, table->num_rows));
-    table->num_rows += 1;
+    pager->map_pages = map_pages;
+    pager->access_pattern = ACCESS_NORMAL;
+}
 
-    return EXECUTE_SUCCESS;
+void pager_unmap(pager_t *pager)
+{
+#ifdef _WIN32
+    UnmapViewOfFile(pager->map);
+    CloseHandle(pager->map_handle);
+#else
+    munmap(pager->map, (size_t)pager->map_pages * PAGE_SIZE);
+#endif
+
+    pager->map = NULL;
+    pager->map_pages = 0;
 }
 
-execute_result_t execute_select(statement_t *statement, table_t *table)
+// Keeps at least MMAP_HEADROOM_PAGES mapped past the last page, in whole
+// extents. Moves the mapping, so it must not run while a page is pinned.
+void pager_reserve(pager_t *pager)
 {
-    row_t row;
-    for (int32_t i = 0; i < table->num_rows; ++i)
+    if (pager->num_pages + MMAP_HEADROOM_PAGES <= pager->map_pages)
     {
-        deserialize_row(row_slot(table, i), &row);
-        print_row(&row);
+        return;
     }
 
-    return EXECUTE_SUCCESS;
-}
-
-execute_result_t execute_statement(statement_t *statement, table_t *table)
-{
-    switch (statement->type)
+    uint32_t map_pages = pager->num_pages + MMAP_HEADROOM_PAGES;
+    map_pages += MMAP_EXTENT_PAGES - map_pages % MMAP_EXTENT_PAGES;
+    if (pager->map != NULL)
     {
-    case STATEMENT_INSERT:
-        return execute_insert(statement, table);
-    case STATEMENT_SELECT:
-        return execute_select(statement, table);
+        pager_unmap(pager);
     }
+    pager_map(pager, map_pages);
 }
 
-int32_t main(int32_t argc, char **argv)
+// Returns the length of the file without the zero pages at its end, and
+// cuts them off. mmap mode grows the file a whole extent at a time and only
+// db_close trims it, so a crash leaves those behind. No node is ever all
+// zeros: a leaf's type is 1 and an internal node always has a right child.
+int64_t file_trim_zero_pages(FILE *file, int64_t file_length)
+{
+    uint8_t *page = malloc(PAGE_SIZE);
+    int64_t length = file_length;
+
+    while (length > 0)
+    {
+        file_seek(file, length - PAGE_SIZE, SEEK_SET);
+        if (fread(page, PAGE_SIZE, 1, file) != 1)
+        {
+            printf("Error reading file: %d\n", errno);
+            exit(EXIT_FAILURE);
+        }
+
+        uint32_t i = 0;
+        while (i < PAGE_SIZE && page[i] == 0)
+        {
+            ++i;
+        }
+        if (i < PAGE_SIZE)
+        {
+            break;
+        }
+        length -= PAGE_SIZE;
+    }
+
+    free(page);
+    if (length != file_length && file_truncate(file, length))
+    {
+        printf("Error truncating db file: %d\n", errno);
+        exit(EXIT_FAILURE);
+    }
+    return length;
+}
+
+pager_t *pager_open(const char *filename, pager_mode_t mode, uint32_t num_frames)
+{
+    // Pages are binary, so the file must not go through newline translation.
+    FILE *file = fopen(filename, "r+b");
+    if (file == NULL)
+    {
+        file = fopen(filename, "w+b");
+        if (file == NULL)
+        {
+            printf("Unable to open file\n");
+            exit(EXIT_FAILURE);
+        }
+        directory_sync(filename);
+    }
+
+    // Reads and writes are whole pages, which stdio would only copy.
+    setvbuf(file, NULL, _IONBF, 0);
+
+    // Logs left by a crash are replayed into the file before its length is
+    // taken. The mapping is written back by the kernel at will, so mmap
+    // mode runs without a log.
+    wal_t *wal = wal_open(filename);
+    if (mode == PAGER_MMAP)
+    {
+        wal_close(wal);
+        wal = NULL;
+    }
+
+    int32_t result = file_seek(file, 0, SEEK_END);
+    if (result)
+    {
+        printf("Error seeking: %d\n", errno);
+        exit(EXIT_FAILURE);
+    }
+
+    int64_t file_length = file_tell(file);
+    if (file_length < 0)
+    {
+        printf("Error seeking: %d\n", errno);
+        exit(EXIT_FAILURE);
+    }
+
+    if (file_length % PAGE_SIZE)
+    {
+        printf("Db file is not a whole number of pages. Corrupt file.\n");
+        exit(EXIT_FAILURE);
+    }
+    file_length = file_trim_zero_pages(file, file_length);
+
+    pager_t *pager = malloc(sizeof(pager_t));
+    pager->file = file;
+    pager->mode = mode;
+    pager->wal = wal;
+    pager->num_pages = (uint32_t)(file_length / PAGE_SIZE);
+    pager->num_frames = 0;
+    pager->clock_hand = 0;
+    pager->frames = NULL;
+    pager->frame_data = NULL;
+    pager->page_frames = NULL;
+    pager->max_pages = 0;
+    pager->map = NULL;
+    pager->map_pages = 0;
+    pager->num_pinned = 0;
+    pager->map_changed = false;
+    pager->access_pattern = ACCESS_NORMAL;
+
+    if (mode == PAGER_MMAP)
+    {
+        pager_reserve(pager);
+        return pager;
+    }
+
+    pager->num_frames = num_frames;
+    pager->frames = malloc(num_frames * sizeof(frame_t));
+    pager->frame_data = malloc((size_t)num_frames * PAGE_SIZE);
+    if (pager->frames == NULL || pager->frame_data == NULL)
+    {
+        printf("Unable to allocate %u buffer pool frames\n", num_frames);
+        exit(EXIT_FAILURE);
+    }
+
+    for (uint32_t i = 0; i < num_frames; ++i)
+    {
+        pager->frames[i].page_num = INVALID_PAGE_NUM;
+        pager->frames[i].pin_count = 0;
+        pager->frames[i].dirty = false;
+        pager->frames[i].referenced = false;
+    }
+
+    return pager;
+}
+
+void *frame_page(pager_t *pager, uint32_t frame_num)
+{
+    return pager->frame_data + (size_t)frame_num * PAGE_SIZE;
+}
+
+// Reads a page from wherever its latest image is: the active log, the log
+// being checkpointed, or the database file.
+void pager_read(pager_t *pager, uint32_t page_num, void *page)
+{
+    wal_t *wal = pager->wal;
+    wal_log_t *active = &wal->logs[wal->active];
+    wal_log_t *frozen = &wal->logs[wal->frozen];
+
+    uint64_t offset = wal_log_find(active, page_num);
+    if (offset != 0)
+    {
+        active->appending = false;
+        wal_read_page(active->file, offset, page);
+        return;
+    }
+
+    offset = wal->has_frozen ? wal_log_find(frozen, page_num) : 0;
+    if (offset != 0)
+    {
+        frozen->appending = false;
+        wal_read_page(frozen->file, offset, page);
+        return;
+    }
+
+    file_seek(pager->file, (int64_t)page_num * PAGE_SIZE, SEEK_SET);
+    int64_t bytes_read = fread(page, sizeof(uint8_t), PAGE_SIZE, pager->file);
+    if (bytes_read < 0 || ferror(pager->file))
+    {
+        printf("Error reading file: %d\n", errno);
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Returns a free frame, evicting a page if there is none. A frame that was
+// used since the hand last passed gets its reference bit cleared and is
+// skipped once, so pages in steady use, like the root, tend to stay.
+uint32_t pager_find_victim(pager_t *pager)
+{
+    // Two sweeps clear every reference bit, so by then any unpinned frame
+    // has been taken.
+    for (uint32_t i = 0; i < 2 * pager->num_frames; ++i)
+    {
+        uint32_t frame_num = pager->clock_hand;
+        frame_t *frame = &pager->frames[frame_num];
+        pager->clock_hand = (pager->clock_hand + 1) % pager->num_frames;
+
+        if (frame->page_num == INVALID_PAGE_NUM)
+        {
+            return frame_num;
+        }
+
+        if (frame->pin_count > 0)
+        {
+            continue;
+        }
+
+        if (frame->referenced)
+        {
+            frame->referenced = false;
+            continue;
+        }
+
+        // The database file only changes at checkpoints, so an evicted page
+        // goes to the log. A crash before the next commit discards it.
+        if (frame->dirty)
+        {
+            wal_append(&pager->wal->logs[pager->wal->active], WAL_FRAME_PAGE, frame->page_num, frame_page(pager, frame_num));
+            pager->wal->num_uncommitted_frames += 1;
+            frame->dirty = false;
+        }
+
+        pager->page_frames[frame->page_num] = 0;
+        frame->page_num = INVALID_PAGE_NUM;
+        return frame_num;
+    }
+
+    printf("Buffer pool exhausted: all %u frames are pinned.\n", pager->num_frames);
+    exit(EXIT_FAILURE);
+}
+
+// Returns the page pinned in memory. It stays at this address until every
+// get_page of it is matched by an unpin_page.
+void *get_page(pager_t *pager, uint32_t page_num)
+{
+    // Pages are allocated one after another, so only the next new one may be
+    // asked for.
+    if (page_num > pager->num_pages || page_num == INVALID_PAGE_NUM)
+    {
+        printf("Tried to fetch page number out of bounds. %u > %u\n", page_num, pager->num_pages);
+        exit(EXIT_FAILURE);
+    }
+
+    if (pager->mode == PAGER_MMAP)
+    {
+        if (pager->num_pinned == 0)
+        {
+            pager_reserve(pager);
+        }
+
+        if (page_num >= pager->map_pages)
+        {
+            printf("Tried to fetch page %u past the mapping while pages are pinned\n", page_num);
+            exit(EXIT_FAILURE);
+        }
+
+        // The mapped part past num_pages came from growing the file, so a
+        // new page is already zeroed.
+        if (page_num == pager->num_pages)
+        {
+            pager->num_pages = page_num + 1;
+        }
+
+        pager->num_pinned += 1;
+        return pager->map + (size_t)page_num * PAGE_SIZE;
+    }
+
+    if (page_num >= pager->max_pages)
+    {
+        uint32_t max_pages = pager->max_pages == 0 ? 64 : pager->max_pages;
+        while (page_num >= max_pages)
+        {
+            max_pages *= 2;
+        }
+
+        pager->page_frames = realloc(pager->page_frames, max_pages * sizeof(uint32_t));
+        memset(pager->page_frames + pager->max_pages, 0, (max_pages - pager->max_pages) * sizeof(uint32_t));
+        pager->max_pages = max_pages;
+    }
+
+    uint32_t frame_num;
+    if (pager->page_frames[page_num] != 0)
+    {
+        frame_num = pager->page_frames[page_num] - 1;
+    }
+    else
+    {
+        frame_num = pager_find_victim(pager);
+        frame_t *frame = &pager->frames[frame_num];
+        void *page = frame_page(pager, frame_num);
+        memset(page, 0, PAGE_SIZE);
+
+        // Every page below num_pages that is not in memory was written out,
+        // either before the file was opened or when it was evicted.
+        if (page_num < pager->num_pages)
+        {
+            pager_read(pager, page_num, page);
+            frame->dirty = false;
+        }
+        else
+        {
+            // A new page is not in the file yet, so it must be written even
+            // if nobody changes it.
+            pager->num_pages = page_num + 1;
+            frame->dirty = true;
+        }
+
+        frame->page_num = page_num;
+        pager->page_frames[page_num] = frame_num + 1;
+    }
+
+    frame_t *frame = &pager->frames[frame_num];
+    frame->pin_count += 1;
+    frame->referenced = true;
+    return frame_page(pager, frame_num);
+}
+
+// Releases a pin taken by get_page. dirty says whether the caller changed
+// the page, so that only changed pages are ever written back.
+void unpin_page(pager_t *pager, uint32_t page_num, bool dirty)
+{
+    // Changes to the mapping are the file's own pages, so there is nothing
+    // to track per page.
+    if (pager->mode == PAGER_MMAP)
+    {
+        if (pager->num_pinned == 0)
+        {
+            printf("Tried to unpin page %u, which is not pinned\n", page_num);
+            exit(EXIT_FAILURE);
+        }
+
+        pager->num_pinned -= 1;
+        pager->map_changed = pager->map_changed || dirty;
+        return;
+    }
+
+    uint32_t frame_num = page_num < pager->max_pages ? pager->page_frames[page_num] : 0;
+    if (frame_num == 0 || pager->frames[frame_num - 1].pin_count == 0)
+    {
+        printf("Tried to unpin page %u, which is not pinned\n", page_num);
+        exit(EXIT_FAILURE);
+    }
+
+    frame_t *frame = &pager->frames[frame_num - 1];
+    frame->pin_count -= 1;
+    frame->dirty = frame->dirty || dirty;
+}
+
+// Makes every statement so far durable with one fsync: the pages they
+// changed go to the log, then a commit frame that also covers any page
+// evicted since the last commit. Runs between statements, when nothing is
+// pinned and every page is whole.
+void wal_commit(pager_t *pager)
+{
+    wal_t *wal = pager->wal;
+    wal_log_t *log = &wal->logs[wal->active];
+
+    for (uint32_t i = 0; i < pager->num_frames; ++i)
+    {
+        frame_t *frame = &pager->frames[i];
+        if (frame->page_num != INVALID_PAGE_NUM && frame->dirty)
+        {
+            wal_append(log, WAL_FRAME_PAGE, frame->page_num, frame_page(pager, i));
+            wal->num_uncommitted_frames += 1;
+            frame->dirty = false;
+        }
+    }
+
+    if (wal->num_uncommitted_frames == 0)
+    {
+        return;
+    }
+
+    wal_append(log, WAL_FRAME_COMMIT, pager->num_pages, NULL);
+    file_sync(log->file);
+    wal->num_uncommitted_frames = 0;
+
+    if (log->length >= WAL_CHECKPOINT_BYTES)
+    {
+        wal_switch(wal);
+    }
+}
+
+// mmap mode's commit: waits until every page changed since the last one is
+// on disk. Unlike a log commit, it cannot keep out the kernel's own earlier
+// write-backs, which may include part of a split.
+void pager_sync_map(pager_t *pager)
+{
+    if (!pager->map_changed)
+    {
+        return;
+    }
+
+#ifdef _WIN32
+    HANDLE file = (HANDLE)_get_osfhandle(_fileno(pager->file));
+    bool failed = !FlushViewOfFile(pager->map, (size_t)pager->num_pages * PAGE_SIZE) || !FlushFileBuffers(file);
+#else
+    bool failed = msync(pager->map, (size_t)pager->num_pages * PAGE_SIZE, MS_SYNC) != 0;
+#endif
+    if (failed)
+    {
+        printf("Error syncing mapping: %d\n", errno);
+        exit(EXIT_FAILURE);
+    }
+
+    pager->map_changed = false;
+}
+
+// Tells the kernel how the mapping is about to be read: readahead for a
+// scan along the leaves, none for point lookups, which would otherwise pull
+// in neighbouring pages they never touch. Windows has no such hint for a
+// mapped view, and the buffer pool reads one page at a time anyway.
+void pager_advise(pager_t *pager, access_pattern_t pattern)
+{
+    if (pager->mode != PAGER_MMAP || pager->access_pattern == pattern)
+    {
+        return;
+    }
+
+#ifndef _WIN32
+    int32_t advice = pattern == ACCESS_SEQUENTIAL ? POSIX_MADV_SEQUENTIAL
+                     : pattern == ACCESS_RANDOM   ? POSIX_MADV_RANDOM
+                                                  : POSIX_MADV_NORMAL;
+    posix_madvise(pager->map, (size_t)pager->map_pages * PAGE_SIZE, advice);
+#endif
+
+    pager->access_pattern = pattern;
+}
+
+// New pages always go at the end of the file; nothing is ever freed.
+uint32_t get_unused_page_num(pager_t *pager)
+{
+    return pager->num_pages;
+}
+
+node_type_t get_node_type(void *node)
+{
+    uint8_t value = *((uint8_t *)(node + NODE_TYPE_OFFSET));
+    return (node_type_t)value;
+}
+
+void set_node_type(void *node, node_type_t type)
+{
+    *((uint8_t *)(node + NODE_TYPE_OFFSET)) = (uint8_t)type;
+}
+
+bool is_node_root(void *node)
+{
+    return *((uint8_t *)(node + IS_ROOT_OFFSET)) != 0;
+}
+
+void set_node_root(void *node, bool is_root)
+{
+    *((uint8_t *)(node + IS_ROOT_OFFSET)) = (uint8_t)is_root;
+}
+
+uint32_t *node_parent(void *node)
+{
+    return node + PARENT_POINTER_OFFSET;
+}
+
+uint32_t *leaf_node_num_cells(void *node)
+{
+    return node + LEAF_NODE_NUM_CELLS_OFFSET;
+}
+
+uint32_t *leaf_node_next_leaf(void *node)
+{
+    return node + LEAF_NODE_NEXT_LEAF_OFFSET;
+}
+
+void *leaf_node_cell(void *node, uint32_t cell_num)
+{
+    return node + LEAF_NODE_HEADER_SIZE + cell_num * LEAF_NODE_CELL_SIZE;
+}
+
+uint32_t *leaf_node_key(void *node, uint32_t cell_num)
+{
+    return leaf_node_cell(node, cell_num) + LEAF_NODE_KEY_OFFSET;
+}
+
+void *leaf_node_value(void *node, uint32_t cell_num)
+{
+    return leaf_node_cell(node, cell_num) + LEAF_NODE_VALUE_OFFSET;
+}
+
+uint32_t *internal_node_num_keys(void *node)
+{
+    return node + INTERNAL_NODE_NUM_KEYS_OFFSET;
+}
+
+uint32_t *internal_node_right_child(void *node)
+{
+    return node + INTERNAL_NODE_RIGHT_CHILD_OFFSET;
+}
+
+uint32_t *internal_node_cell(void *node, uint32_t cell_num)
+{
+    return node + INTERNAL_NODE_HEADER_SIZE + cell_num * INTERNAL_NODE_CELL_SIZE;
+}
+
+// Child num_keys is the right child.
+uint32_t *internal_node_child(void *node, uint32_t child_num)
+{
+    uint32_t num_keys = *internal_node_num_keys(node);
+    if (child_num > num_keys)
+    {
+        printf("Tried to access child_num %u > num_keys %u\n", child_num, num_keys);
+        exit(EXIT_FAILURE);
+    }
+
+    if (child_num == num_keys)
+    {
+        return internal_node_right_child(node);
+    }
+
+    return internal_node_cell(node, child_num);
+}
+
+uint32_t *internal_node_key(void *node, uint32_t key_num)
+{
+    return (void *)internal_node_cell(node, key_num) + INTERNAL_NODE_CHILD_SIZE;
+}
+
+void initialize_leaf_node(void *node)
+{
+    set_node_type(node, NODE_LEAF);
+    set_node_root(node, false);
+    *leaf_node_num_cells(node) = 0;
+    *leaf_node_next_leaf(node) = 0;
+}
+
+void initialize_internal_node(void *node)
+{
+    set_node_type(node, NODE_INTERNAL);
+    set_node_root(node, false);
+    *internal_node_num_keys(node) = 0;
+    *internal_node_right_child(node) = INVALID_PAGE_NUM;
+}
+
+// Internal nodes hold no key for their right child, so the largest key is
+// found at the bottom of the right spine. Only one page of the spine is
+// pinned at a time.
+uint32_t get_node_max_key(pager_t *pager, void *node)
+{
+    if (get_node_type(node) == NODE_LEAF)
+    {
+        return *leaf_node_key(node, *leaf_node_num_cells(node) - 1);
+    }
+
+    uint32_t page_num = *internal_node_right_child(node);
+    while (1)
+    {
+        void *child = get_page(pager, page_num);
+        if (get_node_type(child) == NODE_LEAF)
+        {
+            uint32_t max_key = *leaf_node_key(child, *leaf_node_num_cells(child) - 1);
+            unpin_page(pager, page_num, false);
+            return max_key;
+        }
+
+        uint32_t next_page_num = *internal_node_right_child(child);
+        unpin_page(pager, page_num, false);
+        page_num = next_page_num;
+    }
+}
+
+void print_prompt()
+{
+    printf("db > ");
+}
+
+// Returns false at the end of the input.
+bool read_input(input_buffer_t *input_buffer)
+{
+    int64_t bytes_read = getline(&(input_buffer->buffer), &(input_buffer->buffer_length), input_buffer->stream);
+    if (bytes_read <= 0)
+    {
+        return false;
+    }
+
+    // The last line of a file may have no newline.
+    if (input_buffer->buffer[bytes_read - 1] == '\n')
+    {
+        bytes_read -= 1;
+        input_buffer->buffer[bytes_read] = '\0';
+    }
+    input_buffer->input_length = bytes_read;
+    return true;
+}
+
+void serialize_row(row_t *source, void *destination)
+{
+    memcpy(destination + ID_OFFSET, &(source->id), ID_SIZE);
+    strncpy(destination + USERNAME_OFFSET, source->username, USERNAME_SIZE);
+    strncpy(destination + EMAIL_OFFSET, source->email, EMAIL_SIZE);
+}
+
+void deserialize_row(void *source, row_t *destination)
+{
+    memcpy(&(destination->id), source + ID_OFFSET, ID_SIZE);
+    memcpy(&(destination->username), source + USERNAME_OFFSET, USERNAME_SIZE);
+    memcpy(&(destination->email), source + EMAIL_OFFSET, EMAIL_SIZE);
+}
+
+void print_row(row_t *row)
+{
+    printf("(%d, %s, %s)\n", row->id, row->username, row->email);
+}
+
+void indent(uint32_t level)
+{
+    for (uint32_t i = 0; i < level; ++i)
+    {
+        printf("  ");
+    }
+}
+
+void print_tree(pager_t *pager, uint32_t page_num, uint32_t indentation_level)
+{
+    void *node = get_page(pager, page_num);
+
+    switch (get_node_type(node))
+    {
+    case NODE_LEAF:
+    {
+        uint32_t num_cells = *leaf_node_num_cells(node);
+        indent(indentation_level);
+        printf("- leaf (size %u)\n", num_cells);
+        for (uint32_t i = 0; i < num_cells; ++i)
+        {
+            indent(indentation_level + 1);
+            printf("- %u\n", *leaf_node_key(node, i));
+        }
+        break;
+    }
+    case NODE_INTERNAL:
+    {
+        uint32_t num_keys = *internal_node_num_keys(node);
+        indent(indentation_level);
+        printf("- internal (size %u)\n", num_keys);
+        unpin_page(pager, page_num, false);
+
+        // The node is unpinned while its children print, so a tree deeper
+        // than the buffer pool still prints.
+        for (uint32_t i = 0; i <= num_keys; ++i)
+        {
+            node = get_page(pager, page_num);
+            uint32_t child_page_num = *internal_node_child(node, i);
+            uint32_t key = i < num_keys ? *internal_node_key(node, i) : 0;
+            unpin_page(pager, page_num, false);
+
+            print_tree(pager, child_page_num, indentation_level + 1);
+            if (i < num_keys)
+            {
+                indent(indentation_level + 1);
+                printf("- key %u\n", key);
+            }
+        }
+        return;
+    }
+    }
+
+    unpin_page(pager, page_num, false);
+}
+
+void print_constants()
+{
+    printf("ROW_SIZE: %u\n", ROW_SIZE);
+    printf("COMMON_NODE_HEADER_SIZE: %u\n", COMMON_NODE_HEADER_SIZE);
+    printf("LEAF_NODE_HEADER_SIZE: %u\n", LEAF_NODE_HEADER_SIZE);
+    printf("LEAF_NODE_CELL_SIZE: %u\n", LEAF_NODE_CELL_SIZE);
+    printf("LEAF_NODE_SPACE_FOR_CELLS: %u\n", LEAF_NODE_SPACE_FOR_CELLS);
+    printf("LEAF_NODE_MAX_CELLS: %u\n", LEAF_NODE_MAX_CELLS);
+    printf("INTERNAL_NODE_MAX_KEYS: %u\n", INTERNAL_NODE_MAX_KEYS);
+}
+
+// Returns the position of key in the leaf, or where it would be inserted.
+cursor_t *leaf_node_find(table_t *table, uint32_t page_num, uint32_t key)
+{
+    void *node = get_page(table->pager, page_num);
+    uint32_t num_cells = *leaf_node_num_cells(node);
+
+    cursor_t *cursor = malloc(sizeof(cursor_t));
+    cursor->table = table;
+    cursor->page_num = page_num;
+    cursor->end_of_table = false;
+
+    uint32_t min_index = 0;
+    uint32_t one_past_max_index = num_cells;
+    while (one_past_max_index != min_index)
+    {
+        uint32_t index = (min_index + one_past_max_index) / 2;
+        uint32_t key_at_index = *leaf_node_key(node, index);
+        if (key == key_at_index)
+        {
+            min_index = index;
+            break;
+        }
+
+        if (key < key_at_index)
+        {
+            one_past_max_index = index;
+        }
+        else
+        {
+            min_index = index + 1;
+        }
+    }
+
+    cursor->cell_num = min_index;
+    unpin_page(table->pager, page_num, false);
+    return cursor;
+}
+
+// Returns the index of the child that holds key: the first whose largest
+// key is not below it, or num_keys for the right child.
+uint32_t internal_node_find_child(void *node, uint32_t key)
+{
+    uint32_t num_keys = *internal_node_num_keys(node);
+
+    uint32_t min_index = 0;
+    uint32_t max_index = num_keys;
+    while (min_index != max_index)
+    {
+        uint32_t index = (min_index + max_index) / 2;
+        uint32_t key_to_right = *internal_node_key(node, index);
+        if (key_to_right >= key)
+        {
+            max_index = index;
+        }
+        else
+        {
+            min_index = index + 1;
+        }
+    }
+
+    return min_index;
+}
+
+// Returns the position of key in the leaf level, or where it would be
+// inserted, which may be one past the last cell of its leaf.
+cursor_t *table_find(table_t *table, uint32_t key)
+{
+    uint32_t page_num = table->root_page_num;
+    void *node = get_page(table->pager, page_num);
+
+    while (get_node_type(node) == NODE_INTERNAL)
+    {
+        uint32_t child_page_num = *internal_node_child(node, internal_node_find_child(node, key));
+        unpin_page(table->pager, page_num, false);
+        page_num = child_page_num;
+        node = get_page(table->pager, page_num);
+    }
+
+    unpin_page(table->pager, page_num, false);
+    return leaf_node_find(table, page_num, key);
+}
+
+void cursor_advance(cursor_t *cursor)
+{
+    uint32_t page_num = cursor->page_num;
+    void *node = get_page(cursor->table->pager, page_num);
+
+    cursor->cell_num += 1;
+    if (cursor->cell_num >= *leaf_node_num_cells(node))
+    {
+        uint32_t next_page_num = *leaf_node_next_leaf(node);
+        if (next_page_num == 0)
+        {
+            cursor->end_of_table = true;
+        }
+        else
+        {
+            cursor->page_num = next_page_num;
+            cursor->cell_num = 0;
+        }
+    }
+
+    unpin_page(cursor->table->pager, page_num, false);
+}
+
+// Returns a cursor at the first row whose id is key or larger.
+cursor_t *table_seek(table_t *table, uint32_t key)
+{
+    cursor_t *cursor = table_find(table, key);
+    void *node = get_page(table->pager, cursor->page_num);
+    uint32_t num_cells = *leaf_node_num_cells(node);
+    unpin_page(table->pager, cursor->page_num, false);
+
+    if (num_cells == 0)
+    {
+        cursor->end_of_table = true;
+    }
+    else if (cursor->cell_num >= num_cells)
+    {
+        // Every key of this leaf is smaller, so the row is the first one of
+        // the next leaf.
+        cursor->cell_num = num_cells - 1;
+        cursor_advance(cursor);
+    }
+
+    return cursor;
+}
+
+// Copies out the row under the cursor; the page it lives in may be evicted
+// as soon as it is unpinned.
+void cursor_read_row(cursor_t *cursor, row_t *destination)
+{
+    void *page = get_page(cursor->table->pager, cursor->page_num);
+    deserialize_row(leaf_node_value(page, cursor->cell_num), destination);
+    unpin_page(cursor->table->pager, cursor->page_num, false);
+}
+
+// Gives page 0 a copy of its old contents as left child and
+// right_child_page_num as right child. The root page never moves, so the
+// tree is always found at page 0.
+void create_new_root(table_t *table, uint32_t right_child_page_num)
+{
+    pager_t *pager = table->pager;
+    void *root = get_page(pager, table->root_page_num);
+    void *right_child = get_page(pager, right_child_page_num);
+    uint32_t left_child_page_num = get_unused_page_num(pager);
+    void *left_child = get_page(pager, left_child_page_num);
+
+    memcpy(left_child, root, PAGE_SIZE);
+    set_node_root(left_child, false);
+
+    if (get_node_type(left_child) == NODE_INTERNAL)
+    {
+        for (uint32_t i = 0; i <= *internal_node_num_keys(left_child); ++i)
+        {
+            uint32_t child_page_num = *internal_node_child(left_child, i);
+            void *child = get_page(pager, child_page_num);
+            *node_parent(child) = left_child_page_num;
+            unpin_page(pager, child_page_num, true);
+        }
+    }
+
+    initialize_internal_node(root);
+    set_node_root(root, true);
+    *internal_node_num_keys(root) = 1;
+    *internal_node_child(root, 0) = left_child_page_num;
+    *internal_node_key(root, 0) = get_node_max_key(pager, left_child);
+    *internal_node_right_child(root) = right_child_page_num;
+    *node_parent(left_child) = table->root_page_num;
+    *node_parent(right_child) = table->root_page_num;
+
+    unpin_page(pager, left_child_page_num, true);
+    unpin_page(pager, right_child_page_num, true);
+    unpin_page(pager, table->root_page_num, true);
+}
+
+// The child holding old_key now tops out at new_key. The right child has no
+// key to update.
+void update_internal_node_key(void *node, uint32_t old_key, uint32_t new_key)
+{
+    uint32_t old_child_index = internal_node_find_child(node, old_key);
+    if (old_child_index < *internal_node_num_keys(node))
+    {
+        *internal_node_key(node, old_child_index) = new_key;
+    }
+}
+
+void internal_node_split_and_insert(table_t *table, uint32_t parent_page_num, uint32_t child_page_num);
+
+// Adds the child at child_page_num to the internal node at parent_page_num,
+// in key order.
+void internal_node_insert(table_t *table, uint32_t parent_page_num, uint32_t child_page_num)
+{
+    pager_t *pager = table->pager;
+    void *parent = get_page(pager, parent_page_num);
+    void *child = get_page(pager, child_page_num);
+    uint32_t child_max_key = get_node_max_key(pager, child);
+    uint32_t index = internal_node_find_child(parent, child_max_key);
+
+    uint32_t original_num_keys = *internal_node_num_keys(parent);
+    if (original_num_keys >= INTERNAL_NODE_MAX_KEYS)
+    {
+        unpin_page(pager, child_page_num, false);
+        unpin_page(pager, parent_page_num, false);
+        internal_node_split_and_insert(table, parent_page_num, child_page_num);
+        return;
+    }
+
+    *node_parent(child) = parent_page_num;
+    unpin_page(pager, child_page_num, true);
+
+    uint32_t right_child_page_num = *internal_node_right_child(parent);
+    void *right_child = get_page(pager, right_child_page_num);
+    uint32_t right_child_max_key = get_node_max_key(pager, right_child);
+    unpin_page(pager, right_child_page_num, false);
+
+    *internal_node_num_keys(parent) = original_num_keys + 1;
+    if (child_max_key > right_child_max_key)
+    {
+        // The new child becomes the right child and the old one gets a cell.
+        *internal_node_child(parent, original_num_keys) = right_child_page_num;
+        *internal_node_key(parent, original_num_keys) = right_child_max_key;
+        *internal_node_right_child(parent) = child_page_num;
+    }
+    else
+    {
+        memmove(internal_node_cell(parent, index + 1), internal_node_cell(parent, index),
+                (original_num_keys - index) * INTERNAL_NODE_CELL_SIZE);
+        *internal_node_child(parent, index) = child_page_num;
+        *internal_node_key(parent, index) = child_max_key;
+    }
+
+    unpin_page(pager, parent_page_num, true);
+}
+
+// Once node_page_num has been split off new_page_num, makes the two a new
+// root or adds the new one to their parent. Takes no pins while recursing,
+// so a split all the way up holds only a few pages at a time.
+void link_split_node(table_t *table, uint32_t node_page_num, uint32_t old_max, uint32_t new_page_num)
+{
+    pager_t *pager = table->pager;
+    void *node = get_page(pager, node_page_num);
+    bool is_root = is_node_root(node);
+    uint32_t parent_page_num = *node_parent(node);
+    uint32_t new_max = get_node_max_key(pager, node);
+    unpin_page(pager, node_page_num, false);
+
+    if (is_root)
+    {
+        create_new_root(table, new_page_num);
+        return;
+    }
+
+    void *parent = get_page(pager, parent_page_num);
+    update_internal_node_key(parent, old_max, new_max);
+    unpin_page(pager, parent_page_num, true);
+    internal_node_insert(table, parent_page_num, new_page_num);
+}
+
+// Moves the upper half of a full internal node to a new sibling, adds the
+// child to whichever half it belongs in, then links the sibling into the
+// parent, which may split in turn.
+void internal_node_split_and_insert(table_t *table, uint32_t old_page_num, uint32_t child_page_num)
+{
+    pager_t *pager = table->pager;
+    void *old_node = get_page(pager, old_page_num);
+    uint32_t old_max = get_node_max_key(pager, old_node);
+    uint32_t new_page_num = get_unused_page_num(pager);
+    void *new_node = get_page(pager, new_page_num);
+    initialize_internal_node(new_node);
+    *node_parent(new_node) = *node_parent(old_node);
+
+    // The old node keeps the children up to split_index, which becomes its
+    // right child; the rest, with its old right child, go to the new node.
+    uint32_t num_keys = *internal_node_num_keys(old_node);
+    uint32_t split_index = num_keys / 2;
+    uint32_t num_moved = num_keys - split_index - 1;
+
+    memcpy(internal_node_cell(new_node, 0), internal_node_cell(old_node, split_index + 1), num_moved * INTERNAL_NODE_CELL_SIZE);
+    *internal_node_num_keys(new_node) = num_moved;
+    *internal_node_right_child(new_node) = *internal_node_right_child(old_node);
+    for (uint32_t i = 0; i <= num_moved; ++i)
+    {
+        uint32_t moved_page_num = *internal_node_child(new_node, i);
+        void *moved = get_page(pager, moved_page_num);
+        *node_parent(moved) = new_page_num;
+        unpin_page(pager, moved_page_num, true);
+    }
+
+    uint32_t new_old_max = *internal_node_key(old_node, split_index);
+    *internal_node_right_child(old_node) = *internal_node_child(old_node, split_index);
+    *internal_node_num_keys(old_node) = split_index;
+    unpin_page(pager, new_page_num, true);
+    unpin_page(pager, old_page_num, true);
+
+    void *child = get_page(pager, child_page_num);
+    uint32_t child_max = get_node_max_key(pager, child);
+    unpin_page(pager, child_page_num, false);
+
+    if (child_max > new_old_max)
+    {
+        internal_node_insert(table, new_page_num, child_page_num);
+    }
+    else
+    {
+        internal_node_insert(table, old_page_num, child_page_num);
+    }
+
+    link_split_node(table, old_page_num, old_max, new_page_num);
+}
+
+// Moves the upper half of a full leaf and the new cell to a new leaf linked
+// in after it, then adds the new leaf to the parent.
+void leaf_node_split_and_insert(cursor_t *cursor, uint32_t key, row_t *value)
+{
+    table_t *table = cursor->table;
+    pager_t *pager = table->pager;
+    void *old_node = get_page(pager, cursor->page_num);
+    uint32_t old_max = get_node_max_key(pager, old_node);
+    uint32_t new_page_num = get_unused_page_num(pager);
+    void *new_node = get_page(pager, new_page_num);
+    initialize_leaf_node(new_node);
+    *node_parent(new_node) = *node_parent(old_node);
+    *leaf_node_next_leaf(new_node) = *leaf_node_next_leaf(old_node);
+    *leaf_node_next_leaf(old_node) = new_page_num;
+
+    // Going from the top down, every cell is read before it is overwritten.
+    for (int32_t i = LEAF_NODE_MAX_CELLS; i >= 0; --i)
+    {
+        void *destination_node;
+        uint32_t index_within_node;
+        if ((uint32_t)i >= LEAF_NODE_LEFT_SPLIT_COUNT)
+        {
+            destination_node = new_node;
+            index_within_node = i - LEAF_NODE_LEFT_SPLIT_COUNT;
+        }
+        else
+        {
+            destination_node = old_node;
+            index_within_node = i;
+        }
+        void *destination = leaf_node_cell(destination_node, index_within_node);
+
+        if ((uint32_t)i == cursor->cell_num)
+        {
+            *leaf_node_key(destination_node, index_within_node) = key;
+            serialize_row(value, leaf_node_value(destination_node, index_within_node));
+        }
+        else if ((uint32_t)i > cursor->cell_num)
+        {
+            memcpy(destination, leaf_node_cell(old_node, i - 1), LEAF_NODE_CELL_SIZE);
+        }
+        else
+        {
+            memcpy(destination, leaf_node_cell(old_node, i), LEAF_NODE_CELL_SIZE);
+        }
+    }
+
+    *leaf_node_num_cells(old_node) = LEAF_NODE_LEFT_SPLIT_COUNT;
+    *leaf_node_num_cells(new_node) = LEAF_NODE_RIGHT_SPLIT_COUNT;
+    unpin_page(pager, new_page_num, true);
+    unpin_page(pager, cursor->page_num, true);
+
+    link_split_node(table, cursor->page_num, old_max, new_page_num);
+}
+
+void leaf_node_insert(cursor_t *cursor, uint32_t key, row_t *value)
+{
+    pager_t *pager = cursor->table->pager;
+    void *node = get_page(pager, cursor->page_num);
+
+    uint32_t num_cells = *leaf_node_num_cells(node);
+    if (num_cells >= LEAF_NODE_MAX_CELLS)
+    {
+        unpin_page(pager, cursor->page_num, false);
+        leaf_node_split_and_insert(cursor, key, value);
+        return;
+    }
+
+    if (cursor->cell_num < num_cells)
+    {
+        memmove(leaf_node_cell(node, cursor->cell_num + 1), leaf_node_cell(node, cursor->cell_num),
+                (num_cells - cursor->cell_num) * LEAF_NODE_CELL_SIZE);
+    }
+
+    *leaf_node_num_cells(node) += 1;
+    *leaf_node_key(node, cursor->cell_num) = key;
+    serialize_row(value, leaf_node_value(node, cursor->cell_num));
+    unpin_page(pager, cursor->page_num, true);
+}
+
+execute_result_t table_insert(table_t *table, row_t *row)
+{
+    uint32_t key_to_insert = row->id;
+    pager_advise(table->pager, ACCESS_RANDOM);
+    cursor_t *cursor = table_find(table, key_to_insert);
+
+    void *node = get_page(table->pager, cursor->page_num);
+    uint32_t num_cells = *leaf_node_num_cells(node);
+    bool duplicate = cursor->cell_num < num_cells && *leaf_node_key(node, cursor->cell_num) == key_to_insert;
+    unpin_page(table->pager, cursor->page_num, false);
+    if (duplicate)
+    {
+        free(cursor);
+        return EXECUTE_DUPLICATE_KEY;
+    }
+
+    leaf_node_insert(cursor, key_to_insert, row);
+    free(cursor);
+
+    return EXECUTE_SUCCESS;
+}
+
+// Walks the right spine down from the root.
+void bulk_loader_find_edge(bulk_loader_t *loader)
+{
+    pager_t *pager = loader->table->pager;
+    uint32_t page_nums[BULK_LOAD_MAX_DEPTH];
+    uint32_t depth = 0;
+    uint32_t page_num = loader->table->root_page_num;
+
+    while (1)
+    {
+        if (depth == BULK_LOAD_MAX_DEPTH)
+        {
+            printf("Tree is deeper than %u levels.\n", BULK_LOAD_MAX_DEPTH);
+            exit(EXIT_FAILURE);
+        }
+        page_nums[depth++] = page_num;
+
+        void *node = get_page(pager, page_num);
+        if (get_node_type(node) == NODE_LEAF)
+        {
+            // Only a root leaf is ever empty.
+            uint32_t num_cells = *leaf_node_num_cells(node);
+            loader->empty = num_cells == 0;
+            loader->max_key = num_cells == 0 ? 0 : *leaf_node_key(node, num_cells - 1);
+            unpin_page(pager, page_num, false);
+            break;
+        }
+
+        uint32_t next_page_num = *internal_node_right_child(node);
+        unpin_page(pager, page_num, false);
+        page_num = next_page_num;
+    }
+
+    for (uint32_t i = 0; i < depth; ++i)
+    {
+        loader->page_nums[i] = page_nums[depth - 1 - i];
+    }
+    loader->depth = depth;
+    loader->valid = true;
+}
+
+// Starts a new node at level to the right of the full one there and returns
+// its page number. Everything in the tree is at most max_key, which is
+// therefore the key of the full node in the parent. A full parent gets a new
+// sibling in turn, and a full root is moved down by create_new_root. Holds
+// no pins while recursing.
+uint32_t bulk_loader_add_node(bulk_loader_t *loader, uint32_t level)
+{
+    table_t *table = loader->table;
+    pager_t *pager = table->pager;
+    uint32_t new_page_num = get_unused_page_num(pager);
+    void *new_node = get_page(pager, new_page_num);
+    if (level == 0)
+    {
+        initialize_leaf_node(new_node);
+    }
+    else
+    {
+        initialize_internal_node(new_node);
+    }
+    unpin_page(pager, new_page_num, true);
+
+    // Done before a root leaf is copied away, so the copy links on too.
+    if (level == 0)
+    {
+        void *old_leaf = get_page(pager, loader->page_nums[0]);
+        *leaf_node_next_leaf(old_leaf) = new_page_num;
+        unpin_page(pager, loader->page_nums[0], true);
+    }
+
+    if (level == loader->depth - 1)
+    {
+        if (loader->depth == BULK_LOAD_MAX_DEPTH)
+        {
+            printf("Tree is deeper than %u levels.\n", BULK_LOAD_MAX_DEPTH);
+            exit(EXIT_FAILURE);
+        }
+
+        create_new_root(table, new_page_num);
+        loader->page_nums[level] = new_page_num;
+        loader->page_nums[level + 1] = table->root_page_num;
+        loader->depth += 1;
+        return new_page_num;
+    }
+
+    uint32_t parent_page_num = loader->page_nums[level + 1];
+    void *parent = get_page(pager, parent_page_num);
+    bool parent_full = *internal_node_num_keys(parent) >= INTERNAL_NODE_MAX_KEYS;
+    unpin_page(pager, parent_page_num, false);
+    if (parent_full)
+    {
+        parent_page_num = bulk_loader_add_node(loader, level + 1);
+    }
+
+    // A parent that was just started has no child at all yet.
+    parent = get_page(pager, parent_page_num);
+    uint32_t right_child_page_num = *internal_node_right_child(parent);
+    if (right_child_page_num != INVALID_PAGE_NUM)
+    {
+        uint32_t num_keys = *internal_node_num_keys(parent);
+        *internal_node_num_keys(parent) = num_keys + 1;
+        *internal_node_child(parent, num_keys) = right_child_page_num;
+        *internal_node_key(parent, num_keys) = loader->max_key;
+    }
+    *internal_node_right_child(parent) = new_page_num;
+    unpin_page(pager, parent_page_num, true);
+
+    new_node = get_page(pager, new_page_num);
+    *node_parent(new_node) = parent_page_num;
+    unpin_page(pager, new_page_num, true);
+
+    loader->page_nums[level] = new_page_num;
+    return new_page_num;
+}
+
+// Appends the row to the right edge when its id is above every other one,
+// and inserts it the usual way otherwise.
+execute_result_t bulk_loader_insert(bulk_loader_t *loader, row_t *row)
+{
+    if (!loader->valid)
+    {
+        bulk_loader_find_edge(loader);
+    }
+
+    if (!loader->empty && row->id <= loader->max_key)
+    {
+        // A split may move the right edge.
+        loader->valid = false;
+        return table_insert(loader->table, row);
+    }
+
+    pager_t *pager = loader->table->pager;
+    uint32_t page_num = loader->page_nums[0];
+    void *node = get_page(pager, page_num);
+    uint32_t num_cells = *leaf_node_num_cells(node);
+    if (num_cells >= LEAF_NODE_MAX_CELLS)
+    {
+        unpin_page(pager, page_num, false);
+        page_num = bulk_loader_add_node(loader, 0);
+        node = get_page(pager, page_num);
+        num_cells = 0;
+    }
+
+    *leaf_node_num_cells(node) = num_cells + 1;
+    *leaf_node_key(node, num_cells) = row->id;
+    serialize_row(row, leaf_node_value(node, num_cells));
+    unpin_page(pager, page_num, true);
+
+    loader->empty = false;
+    loader->max_key = row->id;
+    return EXECUTE_SUCCESS;
+}
+
+table_t *db_open(const char *filename, pager_mode_t mode, uint32_t num_frames)
+{
+    pager_t *pager = pager_open(filename, mode, num_frames);
+
+    table_t *table = malloc(sizeof(table_t));
+    table->pager = pager;
+    table->root_page_num = 0;
+
+    if (pager->num_pages == 0)
+    {
+        // New database file: page 0 starts out as an empty root leaf.
+        void *root_node = get_page(pager, 0);
+        initialize_leaf_node(root_node);
+        set_node_root(root_node, true);
+        unpin_page(pager, 0, true);
+    }
+
+    return table;
+}
+
+void db_commit(table_t *table)
+{
+    if (table->pager->wal != NULL)
+    {
+        wal_commit(table->pager);
+    }
+    else if (table->pager->map != NULL)
+    {
+        pager_sync_map(table->pager);
+    }
+}
+
+void db_close(table_t *table)
+{
+    pager_t *pager = table->pager;
+
+    // Only pages changed since they were last written go to the log, and a
+    // final checkpoint copies it all into the database file.
+    if (pager->wal != NULL)
+    {
+        wal_commit(pager);
+        wal_close(pager->wal);
+    }
+
+    // The mapping always runs ahead of the last page; the file must not.
+    if (pager->map != NULL)
+    {
+        pager_unmap(pager);
+        if (file_truncate(pager->file, (int64_t)pager->num_pages * PAGE_SIZE))
+        {
+            printf("Error truncating db file: %d\n", errno);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    int32_t result = fclose(pager->file);
+    if (result)
+    {
+        printf("Error closing db file.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    free(pager->frames);
+    free(pager->frame_data);
+    free(pager->page_frames);
+    free(pager);
+    free(table);
+}
+
+// id,username,email, as a spreadsheet or a database dump writes it. Splits
+// the line in place; strtok would take an empty field for no field at all.
+prepare_result_t parse_csv_row(char *line, row_t *row)
+{
+    char *username = strchr(line, ',');
+    char *email = username == NULL ? NULL : strchr(username + 1, ',');
+    if (email == NULL || strchr(email + 1, ',') != NULL)
+    {
+        return PREPARE_SYNTAX_ERROR;
+    }
+    *username++ = '\0';
+    *email++ = '\0';
+
+    if (line[0] == '-')
+    {
+        return PREPARE_NEGATIVE_ID;
+    }
+
+    uint64_t id = 0;
+    for (char *digit = line; *digit != '\0'; ++digit)
+    {
+        if (*digit < '0' || *digit > '9' || id > INT32_MAX)
+        {
+            return PREPARE_SYNTAX_ERROR;
+        }
+        id = id * 10 + (uint64_t)(*digit - '0');
+    }
+
+    if (line[0] == '\0' || id > INT32_MAX || username[0] == '\0' || email[0] == '\0')
+    {
+        return PREPARE_SYNTAX_ERROR;
+    }
+
+    if (strlen(username) > COLUMN_USERNAME_SIZE || strlen(email) > COLUMN_EMAIL_SIZE)
+    {
+        return PREPARE_STRING_TOO_LONG;
+    }
+
+    row->id = (uint32_t)id;
+    strcpy(row->username, username);
+    strcpy(row->email, email);
+
+    return PREPARE_SUCCESS;
+}
+
+// .import path: loads a CSV file through the bulk loader, reading it in the
+// same large chunks as stdin. Bad lines are reported and skipped.
+void import_csv(table_t *table, const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        printf("Unable to open file %s\n", path);
+        return;
+    }
+
+    // The messages below could push out acknowledgements of statements
+    // that are not committed yet.
+    db_commit(table);
+
+    input_buffer_t *input_buffer = create_input_buffer();
+#ifdef _WIN32
+    input_buffer->stream->fd = _fileno(file);
+#else
+    input_buffer->stream->fd = fileno(file);
+#endif
+    bulk_loader_t loader = {.table = table};
+    uint32_t line_num = 0;
+    uint32_t num_imported = 0;
+    row_t row;
+
+    while (read_input(input_buffer))
+    {
+        line_num += 1;
+        char *line = input_buffer->buffer;
+        if (input_buffer->input_length > 0 && line[input_buffer->input_length - 1] == '\r')
+        {
+            line[input_buffer->input_length - 1] = '\0';
+        }
+        if (line[0] == '\0')
+        {
+            continue;
+        }
+
+        switch (parse_csv_row(line, &row))
+        {
+        case PREPARE_SUCCESS:
+            break;
+        case PREPARE_NEGATIVE_ID:
+            printf("Line %u: ID must be positive.\n", line_num);
+            continue;
+        case PREPARE_STRING_TOO_LONG:
+            printf("Line %u: String is too long.\n", line_num);
+            continue;
+        default:
+            printf("Line %u: Syntax error. Could not parse row.\n", line_num);
+            continue;
+        }
+
+        if (bulk_loader_insert(&loader, &row) == EXECUTE_DUPLICATE_KEY)
+        {
+            printf("Line %u: Error: Duplicate key.\n", line_num);
+            continue;
+        }
+
+        num_imported += 1;
+        if (num_imported % BULK_COMMIT_ROWS == 0)
+        {
+            db_commit(table);
+        }
+    }
+
+    db_commit(table);
+    close_input_buffer(input_buffer);
+    fclose(file);
+    printf("Imported %u rows.\n", num_imported);
+}
+
+meta_command_result_t do_meta_command(input_buffer_t *input_buffer, table_t *table)
+{
+    if (strcmp(input_buffer->buffer, ".exit") == 0)
+    {
+        db_close(table);
+        exit(EXIT_SUCCESS);
+    }
+    else if (strcmp(input_buffer->buffer, ".btree") == 0)
+    {
+        printf("Tree:\n");
+        print_tree(table->pager, table->root_page_num, 0);
+        return META_COMMAND_SUCCESS;
+    }
+    else if (strcmp(input_buffer->buffer, ".constants") == 0)
+    {
+        printf("Constants:\n");
+        print_constants();
+        return META_COMMAND_SUCCESS;
+    }
+    else if (strncmp(input_buffer->buffer, ".import ", 8) == 0)
+    {
+        import_csv(table, input_buffer->buffer + 8);
+        return META_COMMAND_SUCCESS;
+    }
+    else
+    {
+        return META_COMMAND_UNRECOGNIZED_COMMAND;
+    }
+}
+
+prepare_result_t prepare_insert(input_buffer_t *input_buffer, statement_t *statement)
+{
+    statement->type = STATEMENT_INSERT;
+
+    char *keyword = strtok(input_buffer->buffer, " ");
+    char *id_string = strtok(NULL, " ");
+    char *username = strtok(NULL, " ");
+    char *email = strtok(NULL, " ");
+
+    if (id_string == NULL || username == NULL || email == NULL)
+    {
+        return PREPARE_SYNTAX_ERROR;
+    }
+
+    int id = atoi(id_string);
+    if (id < 0)
+    {
+        return PREPARE_NEGATIVE_ID;
+    }
+
+    if (strlen(username) > COLUMN_USERNAME_SIZE)
+    {
+        return PREPARE_STRING_TOO_LONG;
+    }
+
+    if (strlen(email) > COLUMN_EMAIL_SIZE)
+    {
+        return PREPARE_STRING_TOO_LONG;
+    }
+
+    statement->row_to_insert.id = id;
+    strcpy(statement->row_to_insert.username, username);
+    strcpy(statement->row_to_insert.email, email);
+
+    return PREPARE_SUCCESS;
+}
+
+// select           every row
+// select id        the row with that id
+// select from to   the rows with ids from through to
+prepare_result_t prepare_select(input_buffer_t *input_buffer, statement_t *statement)
+{
+    statement->type = STATEMENT_SELECT;
+    statement->select_first_id = 0;
+    statement->select_last_id = UINT32_MAX;
+
+    char *keyword = strtok(input_buffer->buffer, " ");
+    char *first_string = strtok(NULL, " ");
+    char *last_string = strtok(NULL, " ");
+
+    if (strcmp(keyword, "select") != 0 || strtok(NULL, " ") != NULL)
+    {
+        return PREPARE_SYNTAX_ERROR;
+    }
+
+    if (first_string == NULL)
+    {
+        return PREPARE_SUCCESS;
+    }
+
+    int first = atoi(first_string);
+    int last = last_string != NULL ? atoi(last_string) : first;
+    if (first < 0 || last < 0)
+    {
+        return PREPARE_NEGATIVE_ID;
+    }
+
+    statement->select_first_id = first;
+    statement->select_last_id = last;
+
+    return PREPARE_SUCCESS;
+}
+
+prepare_result_t prepare_statement(input_buffer_t *input_buffer, statement_t *statement)
+{
+    if (strncmp(input_buffer->buffer, "insert", 6) == 0)
+    {
+        return prepare_insert(input_buffer, statement);
+    }
+
+    if (strncmp(input_buffer->buffer, "select", 6) == 0)
+    {
+        return prepare_select(input_buffer, statement);
+    }
+
+    return PREPARE_UNRECOGNIZED_STATEMENT;
+}
+
+execute_result_t execute_insert(statement_t *statement, table_t *table)
+{
+    return table_insert(table, &(statement->row_to_insert));
+}
+
+execute_result_t execute_select(statement_t *statement, table_t *table)
+{
+    bool is_scan = statement->select_first_id != statement->select_last_id;
+    pager_advise(table->pager, is_scan ? ACCESS_SEQUENTIAL : ACCESS_RANDOM);
+    cursor_t *cursor = table_seek(table, statement->select_first_id);
+
+    row_t row;
+    while (!cursor->end_of_table)
+    {
+        cursor_read_row(cursor, &row);
+        if (row.id > statement->select_last_id)
+        {
+            break;
+        }
+
+        print_row(&row);
+        cursor_advance(cursor);
+    }
+
+    free(cursor);
+
+    return EXECUTE_SUCCESS;
+}
+
+execute_result_t execute_statement(statement_t *statement, table_t *table)
+{
+    switch (statement->type)
+    {
+    case STATEMENT_INSERT:
+        return execute_insert(statement, table);
+    case STATEMENT_SELECT:
+        return execute_select(statement, table);
+    }
+}
+
+int32_t main(int32_t argc, char **argv)
 {
     if (argc < 2)
     {
@@ -473,17 +2547,82 @@ int32_t main(int32_t argc, char **argv)
         exit(EXIT_FAILURE);
     }
 
+    // db filename [frames | mmap] [--batch]: a buffer pool of that many
+    // frames, or the file mapped into memory, which is synced at each commit
+    // but has no log and is not crash-safe. --batch runs stdin as a script
+    // without prompts or "Executed." lines, appending inserts through the
+    // bulk loader and committing every BULK_COMMIT_ROWS statements.
     char *filename = argv[1];
-    table_t *table = db_open(filename);
+    pager_mode_t mode = PAGER_BUFFER_POOL;
+    uint32_t num_frames = DEFAULT_NUM_FRAMES;
+    bool batch = false;
+    for (int32_t i = 2; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "mmap") == 0)
+        {
+            mode = PAGER_MMAP;
+        }
+        else if (strcmp(argv[i], "--batch") == 0)
+        {
+            batch = true;
+        }
+        else
+        {
+            int frames = atoi(argv[i]);
+            if (frames < (int)MIN_NUM_FRAMES)
+            {
+                printf("Buffer pool needs at least %u frames.\n", MIN_NUM_FRAMES);
+                exit(EXIT_FAILURE);
+            }
+            num_frames = frames;
+        }
+    }
+
+    // Acknowledgements wait in stdout's buffer until they are committed.
+    // The buffer is passed in, as some C libraries ignore the size without
+    // one.
+    setvbuf(stdout, malloc(STDOUT_BUFFER_SIZE), _IOFBF, STDOUT_BUFFER_SIZE);
+
+    table_t *table = db_open(filename, mode, num_frames);
     input_buffer_t *input_buffer = create_input_buffer();
+    uint32_t num_uncommitted = 0;
+    uint32_t max_uncommitted = batch ? BULK_COMMIT_ROWS : GROUP_COMMIT_MAX_STATEMENTS;
+    bulk_loader_t loader = {.table = table};
 
     while (1)
     {
-        print_prompt();
-        read_input(input_buffer);
+        if (!batch)
+        {
+            print_prompt();
+        }
+
+        // Statements that arrive together share one commit, and so one
+        // fsync. Before waiting for more input, everything so far is
+        // committed and let out.
+        if (num_uncommitted >= max_uncommitted || !input_pending(input_buffer->stream))
+        {
+            db_commit(table);
+            fflush(stdout);
+            num_uncommitted = 0;
+        }
+
+        if (!read_input(input_buffer))
+        {
+            // A script simply ends; at the prompt, input ends with .exit.
+            if (batch)
+            {
+                db_close(table);
+                exit(EXIT_SUCCESS);
+            }
+
+            printf("Error reading input\n");
+            db_close(table);
+            exit(EXIT_FAILURE);
+        }
 
         if (input_buffer->buffer[0] == '.')
         {
+            loader.valid = false;
             switch (do_meta_command(input_buffer, table))
             {
             case META_COMMAND_SUCCESS:
@@ -513,13 +2652,28 @@ int32_t main(int32_t argc, char **argv)
             continue;
         }
 
-        switch (execute_statement(&statement, table))
+        // A select may print more than stdout buffers, which would let out
+        // the acknowledgements before it ahead of their commit.
+        if (statement.type == STATEMENT_SELECT && num_uncommitted > 0)
+        {
+            db_commit(table);
+            num_uncommitted = 0;
+        }
+
+        num_uncommitted += 1;
+        execute_result_t result = batch && statement.type == STATEMENT_INSERT
+                                      ? bulk_loader_insert(&loader, &(statement.row_to_insert))
+                                      : execute_statement(&statement, table);
+        switch (result)
         {
         case EXECUTE_SUCCESS:
-            printf("Executed.\n");
+            if (!batch)
+            {
+                printf("Executed.\n");
+            }
             break;
-        case EXECUTE_TABLE_FULL:
-            printf("Error: Table full.\n");
+        case EXECUTE_DUPLICATE_KEY:
+            printf("Error: Duplicate key.\n");
             break;
         }
     }
@@ -7,12 +7,12 @@ public class DBTester
 {
     private static readonly string executablePath = "d:/gitproject/project-based-learning/build/main.exe";
 
-    private static Process? RunProcess([CallerMemberName] string filename = "")
+    private static Process? RunProcess(string arguments = "", [CallerMemberName] string filename = "")
     {
         return Process.Start(new ProcessStartInfo
         {
             FileName = Path.GetFullPath(executablePath),
-            Arguments = $"{filename}.db",
+            Arguments = $"{filename}.db {arguments}",
             WorkingDirectory = Path.GetDirectoryName(executablePath),
             RedirectStandardInput = true,
             RedirectStandardOutput = true,
@@ -57,7 +57,7 @@ public class DBTester
     }
 
     [Fact]
-    public void PrintsErrorMessageWhenTableIsFull()
+    public void AllowsInsertingPastTheOldHundredPageLimit()
     {
         using var process = RunProcess();
         Assert.NotNull(process);
@@ -78,7 +78,304 @@ public class DBTester
 
         process.WaitForExit();
 
-        Assert.Equal("db > Error: Table full.", list[^3]);
+        Assert.All(list.SkipLast(2), line => Assert.Equal("db > Executed.", line));
+    }
+
+    [Fact]
+    public void KeepsEveryRowWithASmallBufferPool()
+    {
+        // 8 frames hold far fewer pages than 300 rows take, so pages are
+        // evicted and read back while inserting and while selecting.
+        const int count = 300;
+        using (var process = RunProcess("8"))
+        {
+            Assert.NotNull(process);
+            WriteLines(process.StandardInput, Enumerable.Range(0, count).Reverse()
+                .Select(i => $"insert {i} person{i} person{i}@example.com")
+                .Append(".exit"));
+
+            ReadLines(process.StandardOutput, Enumerable.Repeat("db > Executed.", count));
+        }
+
+        using (var process = RunProcess("8"))
+        {
+            Assert.NotNull(process);
+            WriteLines(process.StandardInput, [
+                "select",
+                ".exit",
+            ]);
+
+            ReadLines(process.StandardOutput, Enumerable.Range(0, count)
+                .Select(i => $"{(i == 0 ? "db > " : "")}({i}, person{i}, person{i}@example.com)")
+                .Append("Executed."));
+        }
+    }
+
+    [Fact]
+    public void ReadsTheSameFileWithAndWithoutMmap()
+    {
+        using (var process = RunProcess("mmap"))
+        {
+            Assert.NotNull(process);
+            WriteLines(process.StandardInput, [
+                "insert 2 user2 person2@example.com",
+                "insert 1 user1 person1@example.com",
+                ".exit",
+            ]);
+
+            ReadLines(process.StandardOutput, [
+                "db > Executed.",
+                "db > Executed.",
+                "db > ",
+            ]);
+        }
+
+        // Closing cuts the file back to whole pages, or the buffer pool
+        // would see the mapping's spare pages as part of the tree.
+        Assert.Equal(4096, new FileInfo(Path.Combine(Path.GetDirectoryName(executablePath)!, "ReadsTheSameFileWithAndWithoutMmap.db")).Length);
+
+        using (var process = RunProcess())
+        {
+            Assert.NotNull(process);
+            WriteLines(process.StandardInput, [
+                "insert 3 user3 person3@example.com",
+                "select",
+                ".exit",
+            ]);
+
+            ReadLines(process.StandardOutput, [
+                "db > Executed.",
+                "db > (1, user1, person1@example.com)",
+                "(2, user2, person2@example.com)",
+                "(3, user3, person3@example.com)",
+                "Executed.",
+                "db > ",
+            ]);
+        }
+    }
+
+    [Fact]
+    public void TrimsTheMappingsSpareExtentAfterACrash()
+    {
+        using (var process = RunProcess("mmap"))
+        {
+            Assert.NotNull(process);
+            WriteLines(process.StandardInput, [
+                "insert 1 user1 person1@example.com",
+            ]);
+            process.StandardInput.Flush();
+
+            ReadLines(process.StandardOutput, [
+                "db > Executed.",
+            ]);
+            process.Kill();
+            process.WaitForExit();
+        }
+
+        using (var process = RunProcess())
+        {
+            Assert.NotNull(process);
+            WriteLines(process.StandardInput, [
+                "select",
+                ".exit",
+            ]);
+
+            ReadLines(process.StandardOutput, [
+                "db > (1, user1, person1@example.com)",
+                "Executed.",
+                "db > ",
+            ]);
+        }
+
+        // The zero pages the mapping grew the file by are not rows.
+        Assert.Equal(4096, new FileInfo(Path.Combine(Path.GetDirectoryName(executablePath)!, "TrimsTheMappingsSpareExtentAfterACrash.db")).Length);
+    }
+
+    [Fact]
+    public void KeepsCommittedRowsWhenInputEndsWithoutExit()
+    {
+        using (var process = RunProcess())
+        {
+            Assert.NotNull(process);
+            WriteLines(process.StandardInput, [
+                "insert 1 user1 person1@example.com",
+                "insert 2 user2 person2@example.com",
+            ]);
+            process.StandardInput.Close();
+
+            ReadLines(process.StandardOutput, [
+                "db > Executed.",
+                "db > Executed.",
+                "db > Error reading input",
+            ]);
+            process.WaitForExit();
+        }
+
+        // The logs were checkpointed into the database file and removed.
+        var directory = Path.GetDirectoryName(executablePath)!;
+        Assert.False(File.Exists(Path.Combine(directory, "KeepsCommittedRowsWhenInputEndsWithoutExit.db-wal0")));
+        Assert.False(File.Exists(Path.Combine(directory, "KeepsCommittedRowsWhenInputEndsWithoutExit.db-wal1")));
+
+        using (var process = RunProcess())
+        {
+            Assert.NotNull(process);
+            WriteLines(process.StandardInput, [
+                "select",
+                ".exit",
+            ]);
+
+            ReadLines(process.StandardOutput, [
+                "db > (1, user1, person1@example.com)",
+                "(2, user2, person2@example.com)",
+                "Executed.",
+                "db > ",
+            ]);
+        }
+    }
+
+    [Fact]
+    public void ImportsACsvFileIntoFullLeaves()
+    {
+        var csvPath = Path.Combine(Path.GetDirectoryName(executablePath)!, "ImportsACsvFileIntoFullLeaves.csv");
+        File.WriteAllLines(csvPath, [
+            .. Enumerable.Range(1, 26).Select(i => $"{i},user{i},person{i}@example.com"),
+            "27,user27",
+            "1,user1,person1@example.com",
+        ]);
+
+        using var process = RunProcess();
+        Assert.NotNull(process);
+
+        WriteLines(process.StandardInput, [
+            $".import {csvPath}",
+            ".btree",
+            "select 13 14",
+            ".exit",
+        ]);
+
+        // Rows in id order fill each leaf before the next is started.
+        ReadLines(process.StandardOutput, [
+            "db > Line 27: Syntax error. Could not parse row.",
+            "Line 28: Error: Duplicate key.",
+            "Imported 26 rows.",
+            "db > Tree:",
+            "- internal (size 1)",
+            "  - leaf (size 13)",
+            .. Enumerable.Range(1, 13).Select(i => $"    - {i}"),
+            "  - key 13",
+            "  - leaf (size 13)",
+            .. Enumerable.Range(14, 13).Select(i => $"    - {i}"),
+            "db > (13, user13, person13@example.com)",
+            "(14, user14, person14@example.com)",
+            "Executed.",
+            "db > ",
+        ]);
+    }
+
+    [Fact]
+    public void RunsABatchWithoutPromptsOrAcknowledgements()
+    {
+        using var process = RunProcess("--batch");
+        Assert.NotNull(process);
+
+        WriteLines(process.StandardInput, [
+            "insert 2 user2 person2@example.com",
+            "insert 3 user3 person3@example.com",
+            "insert 1 user1 person1@example.com",
+            "insert 3 user3 person3@example.com",
+            "select",
+        ]);
+        process.StandardInput.Close();
+
+        Assert.Equal(string.Join(Environment.NewLine, [
+            "Error: Duplicate key.",
+            "(1, user1, person1@example.com)",
+            "(2, user2, person2@example.com)",
+            "(3, user3, person3@example.com)",
+            "",
+        ]).ReplaceLineEndings(), process.StandardOutput.ReadToEnd().ReplaceLineEndings());
+        process.WaitForExit();
+        Assert.Equal(0, process.ExitCode);
+    }
+
+    [Fact]
+    public void PrintsAnErrorMessageIfThereIsADuplicateId()
+    {
+        using var process = RunProcess();
+        Assert.NotNull(process);
+
+        WriteLines(process.StandardInput, [
+            "insert 1 user1 person1@example.com",
+            "insert 1 user1 person1@example.com",
+            "select",
+            ".exit",
+        ]);
+
+        ReadLines(process.StandardOutput, [
+            "db > Executed.",
+            "db > Error: Duplicate key.",
+            "db > (1, user1, person1@example.com)",
+            "Executed.",
+            "db > ",
+        ]);
+    }
+
+    [Fact]
+    public void SelectsRowsInIdOrderByIdAndByRange()
+    {
+        using var process = RunProcess();
+        Assert.NotNull(process);
+
+        WriteLines(process.StandardInput, [
+            "insert 3 user3 person3@example.com",
+            "insert 1 user1 person1@example.com",
+            "insert 2 user2 person2@example.com",
+            "select",
+            "select 2",
+            "select 2 5",
+            ".exit",
+        ]);
+
+        ReadLines(process.StandardOutput, [
+            "db > Executed.",
+            "db > Executed.",
+            "db > Executed.",
+            "db > (1, user1, person1@example.com)",
+            "(2, user2, person2@example.com)",
+            "(3, user3, person3@example.com)",
+            "Executed.",
+            "db > (2, user2, person2@example.com)",
+            "Executed.",
+            "db > (2, user2, person2@example.com)",
+            "(3, user3, person3@example.com)",
+            "Executed.",
+            "db > ",
+        ]);
+    }
+
+    [Fact]
+    public void PrintsTheStructureOfATwoLeafBtree()
+    {
+        using var process = RunProcess();
+        Assert.NotNull(process);
+
+        WriteLines(process.StandardInput, [
+            .. Enumerable.Range(1, 14).Select(i => $"insert {i} user{i} person{i}@example.com"),
+            ".btree",
+            ".exit",
+        ]);
+
+        ReadLines(process.StandardOutput, [
+            .. Enumerable.Repeat("db > Executed.", 14),
+            "db > Tree:",
+            "- internal (size 1)",
+            "  - leaf (size 7)",
+            .. Enumerable.Range(1, 7).Select(i => $"    - {i}"),
+            "  - key 7",
+            "  - leaf (size 7)",
+            .. Enumerable.Range(8, 7).Select(i => $"    - {i}"),
+            "db > ",
+        ]);
     }
 
     [Fact]